@@ -0,0 +1,93 @@
+#define WOB_FILE "animation.c"
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <string.h>
+
+#include "animation.h"
+
+bool
+wob_parse_easing(const char *str, enum wob_easing *easing)
+{
+	if (strcmp(str, "linear") == 0) {
+		*easing = WOB_EASING_LINEAR;
+	}
+	else if (strcmp(str, "ease-in") == 0) {
+		*easing = WOB_EASING_EASE_IN;
+	}
+	else if (strcmp(str, "ease-out") == 0) {
+		*easing = WOB_EASING_EASE_OUT;
+	}
+	else if (strcmp(str, "ease-in-out") == 0) {
+		*easing = WOB_EASING_EASE_IN_OUT;
+	}
+	else {
+		return false;
+	}
+
+	return true;
+}
+
+// cubic curves, they need no libm and are indistinguishable from the CSS ones at the sizes of a bar
+double
+wob_ease(enum wob_easing easing, double t)
+{
+	double u = 1 - t;
+	switch (easing) {
+		case WOB_EASING_LINEAR:
+			return t;
+		case WOB_EASING_EASE_IN:
+			return t * t * t;
+		case WOB_EASING_EASE_OUT:
+			return 1 - u * u * u;
+		case WOB_EASING_EASE_IN_OUT:
+			return t < 0.5 ? 4 * t * t * t : 1 - 4 * u * u * u;
+	}
+
+	return t;
+}
+
+long long
+wob_animation_elapsed_msec(const struct wob_animation *animation, const struct timespec *now)
+{
+	return (now->tv_sec - animation->start.tv_sec) * 1000LL + (now->tv_nsec - animation->start.tv_nsec) / 1000000;
+}
+
+void
+wob_animation_start(struct wob_animation *animation, double to, const struct timespec *now)
+{
+	animation->from = animation->running ? wob_animation_position(animation, now) : animation->to;
+	animation->to = to;
+	animation->start = *now;
+	animation->running = animation->duration_msec > 0 && animation->from != to;
+}
+
+void
+wob_animation_jump(struct wob_animation *animation, double to)
+{
+	animation->from = to;
+	animation->to = to;
+	animation->running = false;
+}
+
+double
+wob_animation_position(const struct wob_animation *animation, const struct timespec *now)
+{
+	if (!animation->running || wob_animation_finished(animation, now)) {
+		return animation->to;
+	}
+
+	long long elapsed_msec = wob_animation_elapsed_msec(animation, now);
+	if (elapsed_msec <= 0) {
+		return animation->from;
+	}
+
+	double t = (double) elapsed_msec / animation->duration_msec;
+	return animation->from + (animation->to - animation->from) * wob_ease(animation->easing, t);
+}
+
+bool
+wob_animation_finished(const struct wob_animation *animation, const struct timespec *now)
+{
+	return wob_animation_elapsed_msec(animation, now) >= (long long) animation->duration_msec;
+}
@@ -1,44 +1,63 @@
 #define WOB_FILE "buffer.c"
 
-#define _POSIX_C_SOURCE 200112L
+#define _GNU_SOURCE
 
 #include <errno.h>
 #include <fcntl.h>
 #include <limits.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/mman.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "buffer.h"
 #include "log.h"
 
-int
-wob_shm_create()
+// shm_open names only need to be unique among instances started at the same time, pid and time are enough for that
+static int
+wob_shm_open()
 {
-	int shmid = -1;
 	char shm_name[NAME_MAX];
-	for (int i = 0; i < UCHAR_MAX; ++i) {
-		if (snprintf(shm_name, NAME_MAX, "/wob-%d", i) >= NAME_MAX) {
-			break;
+	struct timespec now;
+	for (int i = 0; i < 16; ++i) {
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		snprintf(shm_name, NAME_MAX, "/wob-%ld-%ld-%d", (long) getpid(), (long) now.tv_nsec, i);
+
+		int shmid = shm_open(shm_name, O_RDWR | O_CREAT | O_EXCL, 0600);
+		if (shmid >= 0) {
+			if (shm_unlink(shm_name) != 0) {
+				wob_log_error("shm_unlink() failed: %s", strerror(errno));
+				close(shmid);
+				return -1;
+			}
+
+			return shmid;
 		}
-		shmid = shm_open(shm_name, O_RDWR | O_CREAT | O_EXCL, 0600);
-		if (shmid > 0 || errno != EEXIST) {
+
+		if (errno != EEXIST) {
 			break;
 		}
 	}
 
-	if (shmid < 0) {
-		wob_log_error("shm_open() failed: %s", strerror(errno));
-		return -1;
-	}
+	wob_log_error("shm_open() failed: %s", strerror(errno));
+	return -1;
+}
 
-	if (shm_unlink(shm_name) != 0) {
-		wob_log_error("shm_unlink() failed: %s", strerror(errno));
-		return -1;
+int
+wob_shm_create()
+{
+#ifdef MFD_ALLOW_SEALING
+	int shmid = memfd_create("wob", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+	if (shmid >= 0) {
+		return shmid;
 	}
 
-	return shmid;
+	wob_log_debug("memfd_create() failed: %s, falling back to shm_open()", strerror(errno));
+#endif
+
+	return wob_shm_open();
 }
 
 void *
@@ -49,6 +68,11 @@ wob_shm_alloc(const int shmid, const size_t size)
 		return NULL;
 	}
 
+#ifdef F_SEAL_SHRINK
+	// compositor maps the file too, it must never shrink under its hands; fails harmlessly for shm_open objects
+	fcntl(shmid, F_ADD_SEALS, F_SEAL_SHRINK);
+#endif
+
 	void *buffer = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, shmid, 0);
 	if (buffer == MAP_FAILED) {
 		wob_log_error("mmap() failed: %s", strerror(errno));
@@ -57,3 +81,271 @@ wob_shm_alloc(const int shmid, const size_t size)
 
 	return buffer;
 }
+
+bool
+wob_shm_release(const int shmid, const size_t offset, const size_t size)
+{
+#ifdef FALLOC_FL_PUNCH_HOLE
+	if (fallocate(shmid, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, offset, size) == 0) {
+		return true;
+	}
+
+	wob_log_debug("fallocate() failed: %s", strerror(errno));
+#endif
+
+	// pages of a shared file stay in the page cache until punched out, dropping them from the mapping frees nothing
+	return false;
+}
+
+static void
+wob_buffer_handle_release(void *data, struct wl_buffer *wl_buffer)
+{
+	struct wob_buffer *buffer = (struct wob_buffer *) data;
+
+	buffer->busy = false;
+}
+
+void
+wob_buffer_listen(struct wob_buffer *buffer)
+{
+	const static struct wl_buffer_listener wl_buffer_listener = {
+		.release = wob_buffer_handle_release,
+	};
+
+	wl_buffer_add_listener(buffer->wl_buffer, &wl_buffer_listener, buffer);
+}
+
+bool
+wob_buffer_pool_init(struct wob_buffer_pool *pool, struct wl_shm *wl_shm, unsigned long width, unsigned long height)
+{
+	*pool = (struct wob_buffer_pool){
+		.shmid = -1,
+		.width = width,
+		.height = height,
+		.stride = width * sizeof(uint32_t),
+		.size = width * height * sizeof(uint32_t),
+	};
+
+	pool->shmid = wob_shm_create();
+	if (pool->shmid < 0) {
+		return false;
+	}
+
+	// space for all buffers is reserved upfront, but pages of a buffer are not touched until the buffer is first drawn into
+	pool->capacity = WOB_BUFFER_POOL_CAPACITY * pool->size;
+	pool->data = wob_shm_alloc(pool->shmid, pool->capacity);
+	if (pool->data == NULL) {
+		close(pool->shmid);
+		return false;
+	}
+
+	pool->wl_shm_pool = wl_shm_create_pool(wl_shm, pool->shmid, pool->capacity);
+	if (pool->wl_shm_pool == NULL) {
+		wob_log_error("wl_shm_create_pool failed");
+		munmap(pool->data, pool->capacity);
+		close(pool->shmid);
+		return false;
+	}
+
+	return true;
+}
+
+struct wob_buffer *
+wob_buffer_pool_acquire(struct wob_buffer_pool *pool)
+{
+	for (size_t i = 0; i < pool->count; ++i) {
+		if (!pool->buffers[i].busy) {
+			return &pool->buffers[i];
+		}
+	}
+
+	if (pool->count == WOB_BUFFER_POOL_CAPACITY) {
+		return NULL;
+	}
+
+	struct wob_buffer *buffer = &pool->buffers[pool->count];
+	buffer->argb = pool->data + pool->count * (pool->size / sizeof(uint32_t));
+	buffer->wl_buffer = wl_shm_pool_create_buffer(pool->wl_shm_pool, pool->count * pool->size, pool->width, pool->height, pool->stride, WL_SHM_FORMAT_ARGB8888);
+	if (buffer->wl_buffer == NULL) {
+		wob_log_error("wl_shm_pool_create_buffer failed");
+		return NULL;
+	}
+	wob_buffer_listen(buffer);
+
+	pool->count += 1;
+	wob_log_debug("Buffer pool grown to %zu buffers", pool->count);
+
+	return buffer;
+}
+
+bool
+wob_buffer_pool_release(struct wob_buffer_pool *pool)
+{
+	bool released = true;
+	for (size_t i = 0; i < pool->count; ++i) {
+		struct wob_buffer *buffer = &pool->buffers[i];
+		if (buffer->busy) {
+			released = false;
+			continue;
+		}
+
+		if (buffer->contents.valid) {
+			wob_shm_release(pool->shmid, i * pool->size, pool->size);
+			buffer->contents.valid = false;
+		}
+	}
+
+	return released;
+}
+
+void
+wob_buffer_pool_finish(struct wob_buffer_pool *pool)
+{
+	for (size_t i = 0; i < pool->count; ++i) {
+		wl_buffer_destroy(pool->buffers[i].wl_buffer);
+	}
+	pool->count = 0;
+
+	if (pool->wl_shm_pool != NULL) {
+		wl_shm_pool_destroy(pool->wl_shm_pool);
+		pool->wl_shm_pool = NULL;
+	}
+
+	if (pool->data != NULL) {
+		munmap(pool->data, pool->capacity);
+		pool->data = NULL;
+	}
+
+	if (pool->shmid >= 0) {
+		close(pool->shmid);
+		pool->shmid = -1;
+	}
+}
+
+bool
+wob_atlas_init(struct wob_atlas *atlas, struct wl_shm *wl_shm, unsigned long width, unsigned long height, size_t set_size, size_t set_count)
+{
+	*atlas = (struct wob_atlas){
+		.shmid = -1,
+		.width = width,
+		.height = height,
+		.stride = width * sizeof(uint32_t),
+		.size = width * height * sizeof(uint32_t),
+		.set_size = set_size,
+		.set_count = set_count,
+	};
+
+	size_t count = set_count * set_size;
+	atlas->frames = calloc(count, sizeof(struct wob_buffer));
+	if (atlas->frames == NULL) {
+		wob_log_error("calloc failed");
+		return false;
+	}
+
+	atlas->shmid = wob_shm_create();
+	if (atlas->shmid < 0) {
+		wob_atlas_finish(atlas);
+		return false;
+	}
+
+	// like with the buffer pool, pages of a frame are not touched until the frame is rendered
+	atlas->data = wob_shm_alloc(atlas->shmid, count * atlas->size);
+	if (atlas->data == NULL) {
+		wob_atlas_finish(atlas);
+		return false;
+	}
+
+	atlas->wl_shm_pool = wl_shm_create_pool(wl_shm, atlas->shmid, count * atlas->size);
+	if (atlas->wl_shm_pool == NULL) {
+		wob_log_error("wl_shm_create_pool failed");
+		wob_atlas_finish(atlas);
+		return false;
+	}
+
+	for (size_t i = 0; i < count; ++i) {
+		struct wob_buffer *frame = &atlas->frames[i];
+		frame->argb = atlas->data + i * (atlas->size / sizeof(uint32_t));
+		frame->wl_buffer = wl_shm_pool_create_buffer(atlas->wl_shm_pool, i * atlas->size, atlas->width, atlas->height, atlas->stride, WL_SHM_FORMAT_ARGB8888);
+		if (frame->wl_buffer == NULL) {
+			wob_log_error("wl_shm_pool_create_buffer failed");
+			wob_atlas_finish(atlas);
+			return false;
+		}
+		wob_buffer_listen(frame);
+	}
+
+	wob_log_debug("Atlas of %zu frames created", count);
+
+	return true;
+}
+
+struct wob_buffer *
+wob_atlas_set(struct wob_atlas *atlas, size_t index)
+{
+	return &atlas->frames[index * atlas->set_size];
+}
+
+bool
+wob_atlas_set_busy(struct wob_atlas *atlas, size_t index)
+{
+	struct wob_buffer *frames = wob_atlas_set(atlas, index);
+	for (size_t i = 0; i < atlas->set_size; ++i) {
+		if (frames[i].busy) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool
+wob_atlas_release(struct wob_atlas *atlas)
+{
+	bool released = true;
+	for (size_t i = 0; i < atlas->set_count; ++i) {
+		struct wob_buffer *frames = wob_atlas_set(atlas, i);
+		if (wob_atlas_set_busy(atlas, i)) {
+			released = false;
+			continue;
+		}
+
+		if (atlas->set_colors[i].valid) {
+			wob_shm_release(atlas->shmid, i * atlas->set_size * atlas->size, atlas->set_size * atlas->size);
+			for (size_t j = 0; j < atlas->set_size; ++j) {
+				frames[j].contents.valid = false;
+			}
+			atlas->set_colors[i].valid = false;
+		}
+	}
+
+	return released;
+}
+
+void
+wob_atlas_finish(struct wob_atlas *atlas)
+{
+	if (atlas->frames != NULL) {
+		for (size_t i = 0; i < atlas->set_count * atlas->set_size; ++i) {
+			if (atlas->frames[i].wl_buffer != NULL) {
+				wl_buffer_destroy(atlas->frames[i].wl_buffer);
+			}
+		}
+		free(atlas->frames);
+		atlas->frames = NULL;
+	}
+
+	if (atlas->wl_shm_pool != NULL) {
+		wl_shm_pool_destroy(atlas->wl_shm_pool);
+		atlas->wl_shm_pool = NULL;
+	}
+
+	if (atlas->data != NULL) {
+		munmap(atlas->data, atlas->set_count * atlas->set_size * atlas->size);
+		atlas->data = NULL;
+	}
+
+	if (atlas->shmid >= 0) {
+		close(atlas->shmid);
+		atlas->shmid = -1;
+	}
+}
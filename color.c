@@ -4,26 +4,22 @@
 
 #include "color.h"
 
-uint32_t
-wob_color_to_argb(const struct wob_color color)
+// channel * alpha / 255 rounded to nearest, exact for all 8-bit inputs
+static uint32_t
+wob_color_multiply(uint32_t channel, uint32_t alpha)
 {
-	uint8_t alpha = (uint8_t) (color.a * UINT8_MAX);
-	uint8_t red = (uint8_t) (color.r * UINT8_MAX);
-	uint8_t green = (uint8_t) (color.g * UINT8_MAX);
-	uint8_t blue = (uint8_t) (color.b * UINT8_MAX);
+	uint32_t product = channel * alpha + 128;
 
-	return (alpha << 24) + (red << 16) + (green << 8) + blue;
+	return (product + (product >> 8)) >> 8;
 }
 
 struct wob_color
-wob_color_premultiply_alpha(const struct wob_color color)
+wob_color_from_argb(const uint32_t argb)
 {
-	struct wob_color premultiplied_color = {
-		.a = color.a,
-		.r = color.r * color.a,
-		.g = color.g * color.a,
-		.b = color.b * color.a,
-	};
+	uint32_t alpha = (argb >> 24) & 0xFF;
+	uint32_t red = wob_color_multiply((argb >> 16) & 0xFF, alpha);
+	uint32_t green = wob_color_multiply((argb >> 8) & 0xFF, alpha);
+	uint32_t blue = wob_color_multiply(argb & 0xFF, alpha);
 
-	return premultiplied_color;
+	return (struct wob_color){.argb = (alpha << 24) | (red << 16) | (green << 8) | blue};
 }
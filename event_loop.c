@@ -0,0 +1,98 @@
+#define WOB_FILE "event_loop.c"
+
+#define WOB_EVENT_LOOP_MAX_EVENTS 16
+
+#include <errno.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include "event_loop.h"
+#include "log.h"
+
+bool
+wob_event_loop_init(struct wob_event_loop *loop)
+{
+	loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	if (loop->epoll_fd == -1) {
+		wob_log_error("epoll_create1() failed: %s", strerror(errno));
+		return false;
+	}
+
+	return true;
+}
+
+bool
+wob_event_loop_add(struct wob_event_loop *loop, struct wob_event_source *source, uint32_t events)
+{
+	struct epoll_event event = {
+		.events = events,
+		.data.ptr = source,
+	};
+
+	if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, source->fd, &event) == -1) {
+		wob_log_error("epoll_ctl(EPOLL_CTL_ADD) failed for fd %d: %s", source->fd, strerror(errno));
+		return false;
+	}
+
+	return true;
+}
+
+bool
+wob_event_loop_modify(struct wob_event_loop *loop, struct wob_event_source *source, uint32_t events)
+{
+	struct epoll_event event = {
+		.events = events,
+		.data.ptr = source,
+	};
+
+	if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_MOD, source->fd, &event) == -1) {
+		wob_log_error("epoll_ctl(EPOLL_CTL_MOD) failed for fd %d: %s", source->fd, strerror(errno));
+		return false;
+	}
+
+	return true;
+}
+
+bool
+wob_event_loop_remove(struct wob_event_loop *loop, struct wob_event_source *source)
+{
+	if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_DEL, source->fd, NULL) == -1) {
+		wob_log_error("epoll_ctl(EPOLL_CTL_DEL) failed for fd %d: %s", source->fd, strerror(errno));
+		return false;
+	}
+
+	return true;
+}
+
+bool
+wob_event_loop_dispatch(struct wob_event_loop *loop, int timeout_msec)
+{
+	struct epoll_event events[WOB_EVENT_LOOP_MAX_EVENTS];
+
+	int count = epoll_wait(loop->epoll_fd, events, WOB_EVENT_LOOP_MAX_EVENTS, timeout_msec);
+	if (count == -1) {
+		if (errno == EINTR) {
+			return true;
+		}
+
+		wob_log_error("epoll_wait() failed: %s", strerror(errno));
+		return false;
+	}
+
+	for (int i = 0; i < count; ++i) {
+		struct wob_event_source *source = events[i].data.ptr;
+		source->handle(source, events[i].events);
+	}
+
+	return true;
+}
+
+void
+wob_event_loop_finish(struct wob_event_loop *loop)
+{
+	if (loop->epoll_fd >= 0) {
+		close(loop->epoll_fd);
+		loop->epoll_fd = -1;
+	}
+}
@@ -0,0 +1,212 @@
+#define WOB_FILE "fill.c"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define WOB_FILL_X86
+#include <immintrin.h>
+#endif
+
+#include "fill.h"
+
+struct wob_fill_kernels {
+	void (*fill)(uint32_t *destination, uint32_t value, size_t count, bool non_temporal);
+	void (*copy)(uint32_t *destination, const uint32_t *source, size_t count, bool non_temporal);
+};
+
+// plain stores, non-temporal ones need vector instructions
+static void
+wob_fill_generic(uint32_t *destination, uint32_t value, size_t count, bool non_temporal)
+{
+	(void) non_temporal;
+
+	for (size_t i = 0; i < count; ++i) {
+		destination[i] = value;
+	}
+}
+
+static void
+wob_copy_generic(uint32_t *destination, const uint32_t *source, size_t count, bool non_temporal)
+{
+	(void) non_temporal;
+
+	memcpy(destination, source, count * sizeof(uint32_t));
+}
+
+#ifdef WOB_FILL_X86
+// vector stores are aligned to the vector size, pixels before the first aligned one are written one by one
+
+__attribute__((target("sse2"))) static void
+wob_fill_sse2(uint32_t *destination, uint32_t value, size_t count, bool non_temporal)
+{
+	for (; count > 0 && ((uintptr_t) destination & 15) != 0; --count) {
+		*destination++ = value;
+	}
+
+	__m128i vector = _mm_set1_epi32((int) value);
+	if (non_temporal) {
+		for (; count >= 4; count -= 4, destination += 4) {
+			_mm_stream_si128((__m128i *) destination, vector);
+		}
+		_mm_sfence();
+	}
+	else {
+		for (; count >= 4; count -= 4, destination += 4) {
+			_mm_store_si128((__m128i *) destination, vector);
+		}
+	}
+
+	for (; count > 0; --count) {
+		*destination++ = value;
+	}
+}
+
+__attribute__((target("sse2"))) static void
+wob_copy_sse2(uint32_t *destination, const uint32_t *source, size_t count, bool non_temporal)
+{
+	for (; count > 0 && ((uintptr_t) destination & 15) != 0; --count) {
+		*destination++ = *source++;
+	}
+
+	if (non_temporal) {
+		for (; count >= 4; count -= 4, destination += 4, source += 4) {
+			_mm_stream_si128((__m128i *) destination, _mm_loadu_si128((const __m128i *) source));
+		}
+		_mm_sfence();
+	}
+	else {
+		for (; count >= 4; count -= 4, destination += 4, source += 4) {
+			_mm_store_si128((__m128i *) destination, _mm_loadu_si128((const __m128i *) source));
+		}
+	}
+
+	for (; count > 0; --count) {
+		*destination++ = *source++;
+	}
+}
+
+__attribute__((target("avx2"))) static void
+wob_fill_avx2(uint32_t *destination, uint32_t value, size_t count, bool non_temporal)
+{
+	for (; count > 0 && ((uintptr_t) destination & 31) != 0; --count) {
+		*destination++ = value;
+	}
+
+	__m256i vector = _mm256_set1_epi32((int) value);
+	if (non_temporal) {
+		for (; count >= 8; count -= 8, destination += 8) {
+			_mm256_stream_si256((__m256i *) destination, vector);
+		}
+		_mm_sfence();
+	}
+	else {
+		for (; count >= 8; count -= 8, destination += 8) {
+			_mm256_store_si256((__m256i *) destination, vector);
+		}
+	}
+
+	for (; count > 0; --count) {
+		*destination++ = value;
+	}
+}
+
+__attribute__((target("avx2"))) static void
+wob_copy_avx2(uint32_t *destination, const uint32_t *source, size_t count, bool non_temporal)
+{
+	for (; count > 0 && ((uintptr_t) destination & 31) != 0; --count) {
+		*destination++ = *source++;
+	}
+
+	if (non_temporal) {
+		for (; count >= 8; count -= 8, destination += 8, source += 8) {
+			_mm256_stream_si256((__m256i *) destination, _mm256_loadu_si256((const __m256i *) source));
+		}
+		_mm_sfence();
+	}
+	else {
+		for (; count >= 8; count -= 8, destination += 8, source += 8) {
+			_mm256_store_si256((__m256i *) destination, _mm256_loadu_si256((const __m256i *) source));
+		}
+	}
+
+	for (; count > 0; --count) {
+		*destination++ = *source++;
+	}
+}
+#endif
+
+static const struct wob_fill_kernels wob_fill_generic_kernels = {.fill = wob_fill_generic, .copy = wob_copy_generic};
+#ifdef WOB_FILL_X86
+static const struct wob_fill_kernels wob_fill_sse2_kernels = {.fill = wob_fill_sse2, .copy = wob_copy_sse2};
+static const struct wob_fill_kernels wob_fill_avx2_kernels = {.fill = wob_fill_avx2, .copy = wob_copy_avx2};
+#endif
+
+static const struct wob_fill_kernels *wob_fill_selected_kernels = &wob_fill_generic_kernels;
+static pthread_once_t wob_fill_kernels_once = PTHREAD_ONCE_INIT;
+
+static void
+wob_fill_select_kernels(void)
+{
+#ifdef WOB_FILL_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		wob_fill_selected_kernels = &wob_fill_avx2_kernels;
+	}
+	else if (__builtin_cpu_supports("sse2")) {
+		wob_fill_selected_kernels = &wob_fill_sse2_kernels;
+	}
+#endif
+}
+
+// render workers draw at the same time, the first of them to get here selects the kernels for all
+static const struct wob_fill_kernels *
+wob_fill_kernels(void)
+{
+	pthread_once(&wob_fill_kernels_once, wob_fill_select_kernels);
+
+	return wob_fill_selected_kernels;
+}
+
+void
+wob_fill(uint32_t *destination, uint32_t value, size_t count)
+{
+	wob_fill_kernels()->fill(destination, value, count, count * sizeof(uint32_t) >= WOB_FILL_NON_TEMPORAL_THRESHOLD);
+}
+
+void
+wob_fill_rect(uint32_t *destination, size_t stride, size_t width, size_t height, uint32_t value)
+{
+	if (width == 0 || height == 0) {
+		return;
+	}
+
+	// rect spanning whole rows is one contiguous fill
+	if (width == stride) {
+		wob_fill(destination, value, width * height);
+		return;
+	}
+
+	const struct wob_fill_kernels *kernels = wob_fill_kernels();
+	bool non_temporal = width * height * sizeof(uint32_t) >= WOB_FILL_NON_TEMPORAL_THRESHOLD;
+	for (size_t line = 0; line < height; ++line) {
+		kernels->fill(destination + line * stride, value, width, non_temporal);
+	}
+}
+
+void
+wob_replicate_row(uint32_t *row, size_t stride, size_t width, size_t height)
+{
+	if (width == 0) {
+		return;
+	}
+
+	const struct wob_fill_kernels *kernels = wob_fill_kernels();
+	bool non_temporal = width * height * sizeof(uint32_t) >= WOB_FILL_NON_TEMPORAL_THRESHOLD;
+	for (size_t line = 1; line < height; ++line) {
+		kernels->copy(row + line * stride, row, width, non_temporal);
+	}
+}
@@ -0,0 +1,36 @@
+#ifndef _WOB_ANIMATION_H
+#define _WOB_ANIMATION_H
+
+#include <stdbool.h>
+#include <time.h>
+
+enum wob_easing {
+	WOB_EASING_LINEAR,
+	WOB_EASING_EASE_IN,
+	WOB_EASING_EASE_OUT,
+	WOB_EASING_EASE_IN_OUT,
+};
+
+// fill of the bar moving from one fraction of its width to another, 0 duration disables it
+struct wob_animation {
+	enum wob_easing easing;
+	unsigned long duration_msec;
+	double from;
+	double to;
+	struct timespec start;
+	bool running;
+};
+
+bool wob_parse_easing(const char *str, enum wob_easing *easing);
+
+// starts from wherever the fill is shown at the moment, so an animation can be retargeted halfway
+void wob_animation_start(struct wob_animation *animation, double to, const struct timespec *now);
+
+// shows the fill at the target right away, like a bar showing up after being hidden
+void wob_animation_jump(struct wob_animation *animation, double to);
+
+double wob_animation_position(const struct wob_animation *animation, const struct timespec *now);
+
+bool wob_animation_finished(const struct wob_animation *animation, const struct timespec *now);
+
+#endif
@@ -1,10 +1,96 @@
 #ifndef _WOB_BUFFER_H
 #define _WOB_BUFFER_H
 
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
+
+#include <wayland-client.h>
+
+// the pool only grows when the compositor holds all of its buffers, every channel shown with a shared renderer holds one
+#define WOB_BUFFER_POOL_CAPACITY 8
+
+// what a buffer or surface currently shows, maintained by the renderer
+struct wob_contents {
+	bool valid;
+	unsigned long bar_width;
+	uint32_t bar;
+	uint32_t background;
+	uint32_t border;
+};
+
+struct wob_buffer {
+	struct wl_buffer *wl_buffer;
+	uint32_t *argb;
+	bool busy;
+	struct wob_contents contents;
+};
+
+struct wob_buffer_pool {
+	int shmid;
+	uint32_t *data;
+	struct wl_shm_pool *wl_shm_pool;
+	unsigned long width;
+	unsigned long height;
+	unsigned long stride;
+	unsigned long size;
+	// bytes mapped, WOB_BUFFER_POOL_CAPACITY * size
+	size_t capacity;
+	size_t count;
+	struct wob_buffer buffers[WOB_BUFFER_POOL_CAPACITY];
+};
+
+// the atlas keeps every fill state of the bar for up to this many color sets, normal and overflow colors fit side by side
+#define WOB_ATLAS_CAPACITY 2
+// sets are only kept as long as they fit, without room for a single one the bar is drawn into the buffer pool instead
+#define WOB_ATLAS_MAX_SIZE (32UL * 1024 * 1024)
+
+struct wob_atlas {
+	int shmid;
+	uint32_t *data;
+	struct wl_shm_pool *wl_shm_pool;
+	unsigned long width;
+	unsigned long height;
+	unsigned long stride;
+	unsigned long size;
+	// frames of a set, one for every possible bar_width
+	size_t set_size;
+	size_t set_count;
+	// colors every set is rendered with, frames of a set are only rendered once they are first shown
+	struct wob_contents set_colors[WOB_ATLAS_CAPACITY];
+	// set that was used last, others are replaced first
+	size_t current;
+	struct wob_buffer *frames;
+};
 
 int wob_shm_create();
 
 void *wob_shm_alloc(int shmid, size_t size);
 
+// gives pages of the range back to the system, their contents are lost, false when the file system cannot punch holes
+bool wob_shm_release(int shmid, size_t offset, size_t size);
+
+bool wob_buffer_pool_init(struct wob_buffer_pool *pool, struct wl_shm *wl_shm, unsigned long width, unsigned long height);
+
+struct wob_buffer *wob_buffer_pool_acquire(struct wob_buffer_pool *pool);
+
+// tracks wl_buffer.release of a buffer, busy is cleared once the compositor lets go of it
+void wob_buffer_listen(struct wob_buffer *buffer);
+
+// releases memory of buffers not held by compositor, returns true once there is none left
+bool wob_buffer_pool_release(struct wob_buffer_pool *pool);
+
+void wob_buffer_pool_finish(struct wob_buffer_pool *pool);
+
+bool wob_atlas_init(struct wob_atlas *atlas, struct wl_shm *wl_shm, unsigned long width, unsigned long height, size_t set_size, size_t set_count);
+
+struct wob_buffer *wob_atlas_set(struct wob_atlas *atlas, size_t index);
+
+bool wob_atlas_set_busy(struct wob_atlas *atlas, size_t index);
+
+// releases memory of sets not held by compositor, they are rendered again when needed, returns true once there is none left
+bool wob_atlas_release(struct wob_atlas *atlas);
+
+void wob_atlas_finish(struct wob_atlas *atlas);
+
 #endif
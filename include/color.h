@@ -3,15 +3,12 @@
 
 #include <stdint.h>
 
+// premultiplied alpha ARGB, stored into buffers as is
 struct wob_color {
-	float a;
-	float r;
-	float g;
-	float b;
+	uint32_t argb;
 };
 
-uint32_t wob_color_to_argb(struct wob_color color);
-
-struct wob_color wob_color_premultiply_alpha(struct wob_color color);
+// argb is 0xAARRGGBB with straight alpha
+struct wob_color wob_color_from_argb(uint32_t argb);
 
 #endif
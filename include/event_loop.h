@@ -0,0 +1,29 @@
+#ifndef _WOB_EVENT_LOOP_H
+#define _WOB_EVENT_LOOP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+struct wob_event_source {
+	int fd;
+	// called with the epoll events the fd became ready for
+	void (*handle)(struct wob_event_source *source, uint32_t events);
+};
+
+struct wob_event_loop {
+	int epoll_fd;
+};
+
+bool wob_event_loop_init(struct wob_event_loop *loop);
+
+bool wob_event_loop_add(struct wob_event_loop *loop, struct wob_event_source *source, uint32_t events);
+
+bool wob_event_loop_modify(struct wob_event_loop *loop, struct wob_event_source *source, uint32_t events);
+
+bool wob_event_loop_remove(struct wob_event_loop *loop, struct wob_event_source *source);
+
+bool wob_event_loop_dispatch(struct wob_event_loop *loop, int timeout_msec);
+
+void wob_event_loop_finish(struct wob_event_loop *loop);
+
+#endif
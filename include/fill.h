@@ -0,0 +1,18 @@
+#ifndef _WOB_FILL_H
+#define _WOB_FILL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// stores of larger operations bypass the cache, smaller buffers are likely still cached when the compositor reads them
+#define WOB_FILL_NON_TEMPORAL_THRESHOLD (4 * 1024 * 1024)
+
+void wob_fill(uint32_t *destination, uint32_t value, size_t count);
+
+// stride is in pixels
+void wob_fill_rect(uint32_t *destination, size_t stride, size_t width, size_t height, uint32_t value);
+
+// copies first width pixels of row to the following height - 1 rows
+void wob_replicate_row(uint32_t *row, size_t stride, size_t width, size_t height);
+
+#endif
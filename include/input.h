@@ -0,0 +1,38 @@
+#ifndef _WOB_INPUT_H
+#define _WOB_INPUT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define WOB_INPUT_BUFFER_SIZE 4096
+// descriptors kept from a UNIX socket, more are closed right away
+#define WOB_INPUT_MAX_FDS 2
+
+enum wob_input_status {
+	WOB_INPUT_AGAIN,
+	WOB_INPUT_EOF,
+	WOB_INPUT_ERROR,
+};
+
+struct wob_input {
+	int fd;
+	// offset of the first byte not yet returned by wob_input_next_line()
+	size_t start;
+	size_t length;
+	// set for UNIX sockets that may carry descriptors, they are collected in fds
+	bool receive_fds;
+	size_t fd_count;
+	int fds[WOB_INPUT_MAX_FDS];
+	// one extra byte keeps the data NUL terminated
+	char buffer[WOB_INPUT_BUFFER_SIZE + 1];
+};
+
+bool wob_input_init(struct wob_input *input, int fd);
+
+enum wob_input_status wob_input_fill(struct wob_input *input);
+
+char *wob_input_next_line(struct wob_input *input);
+
+const unsigned char *wob_input_next_frame(struct wob_input *input, size_t frame_size);
+
+#endif
@@ -2,11 +2,37 @@
 #define _WOB_PARSE_H
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #include "color.h"
 
+enum wob_command {
+	// value is the new value
+	WOB_COMMAND_SET,
+	// value is added to or subtracted from the current one, "+<value>" and "-<value>"
+	WOB_COMMAND_INCREASE,
+	WOB_COMMAND_DECREASE,
+	// bar is shown or hidden keeping its value, "show" and "hide"
+	WOB_COMMAND_SHOW,
+	WOB_COMMAND_HIDE,
+	// bar stays visible for another timeout, "refresh-timeout"
+	WOB_COMMAND_REFRESH_TIMEOUT,
+};
+
 bool wob_parse_color(const char *restrict str, char **restrict str_end, struct wob_color *color);
 
+// binary input frame, all fields little-endian:
+// uint32 value, uint32 background, uint32 border, uint32 bar (colors as 0xAARRGGBB), uint8 flags, uint8 command, 2 reserved zero bytes
+#define WOB_BINARY_INPUT_FRAME_SIZE 20
+
+// background, border and bar colors of the frame are applied
+#define WOB_BINARY_INPUT_FLAG_COLORS 0x01
+
+bool wob_parse_binary_input(const unsigned char *frame, enum wob_command *command, unsigned long *percentage, struct wob_color *background, struct wob_color *border, struct wob_color *bar);
+
 bool wob_parse_input(const char *input_buffer, unsigned long *percentage, struct wob_color *background, struct wob_color *border, struct wob_color *bar);
 
+bool wob_parse_command(
+	const char *input_buffer, enum wob_command *command, unsigned long *percentage, struct wob_color *background, struct wob_color *border, struct wob_color *bar);
+
 #endif
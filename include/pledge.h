@@ -3,6 +3,7 @@
 
 #include <stdbool.h>
 
-bool wob_pledge(void);
+// files given with --watch still need to be opened and watched afterwards, the socket of --socket removed on exit
+bool wob_pledge(bool watch_files, bool remove_socket);
 
 #endif
@@ -0,0 +1,35 @@
+#ifndef _WOB_POOL_H
+#define _WOB_POOL_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define WOB_POOL_MAX_WORKERS 3
+
+// worker threads sharing jobs with the calling thread, spawned on first use
+struct wob_pool {
+	size_t max_workers;
+	size_t worker_count;
+	pthread_t workers[WOB_POOL_MAX_WORKERS];
+	pthread_mutex_t mutex;
+	// workers wait for jobs
+	pthread_cond_t work;
+	// caller waits for the workers to finish
+	pthread_cond_t done;
+	void (*run)(void *data, size_t index);
+	void *data;
+	size_t job_count;
+	size_t next;
+	size_t finished;
+	bool stop;
+};
+
+bool wob_pool_init(struct wob_pool *pool, size_t max_workers);
+
+// runs every job, returns once all of them are done
+void wob_pool_run(struct wob_pool *pool, void (*run)(void *data, size_t index), void *data, size_t job_count);
+
+void wob_pool_finish(struct wob_pool *pool);
+
+#endif
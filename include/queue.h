@@ -0,0 +1,45 @@
+#ifndef _WOB_QUEUE_H
+#define _WOB_QUEUE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "color.h"
+#include "parse.h"
+
+// power of two, indices wrap around freely
+#define WOB_QUEUE_CAPACITY 256
+
+// keeps the indices of producer and consumer on cache lines of their own
+#define WOB_QUEUE_CACHE_LINE_SIZE 64
+
+struct wob_channel;
+
+// value parsed by the input thread, applied by the main thread
+struct wob_update {
+	struct wob_channel *channel;
+	enum wob_command command;
+	unsigned long percentage;
+	struct wob_color background;
+	struct wob_color border;
+	struct wob_color bar;
+};
+
+// lock-free ring buffer for a single producer and a single consumer thread
+struct wob_queue {
+	// written by the consumer only
+	size_t head;
+	char head_padding[WOB_QUEUE_CACHE_LINE_SIZE - sizeof(size_t)];
+	// written by the producer only
+	size_t tail;
+	char tail_padding[WOB_QUEUE_CACHE_LINE_SIZE - sizeof(size_t)];
+	struct wob_update updates[WOB_QUEUE_CAPACITY];
+};
+
+void wob_queue_init(struct wob_queue *queue);
+
+bool wob_queue_push(struct wob_queue *queue, const struct wob_update *update);
+
+bool wob_queue_pop(struct wob_queue *queue, struct wob_update *update);
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef _WOB_SERVER_H
+#define _WOB_SERVER_H
+
+#include <stdbool.h>
+
+#include "color.h"
+
+struct wob_shm;
+struct wob_shm_snapshot;
+
+// first file descriptor passed by the service manager, see sd_listen_fds(3)
+#define WOB_SERVER_LISTEN_FDS_START 3
+
+// fails when another instance still listens on the path, a socket left behind is replaced
+int wob_server_listen(const char *path);
+
+int wob_server_listen_fds(void);
+
+bool wob_server_adopt(int fd);
+
+int wob_server_accept(int listen_fd);
+
+const struct wob_shm *wob_server_map_shm(int memfd);
+
+void wob_server_unmap_shm(const struct wob_shm *shm);
+
+// producers publish straight alpha like every other input, wob keeps colors premultiplied
+void wob_server_shm_colors(const struct wob_shm_snapshot *snapshot, struct wob_color *background, struct wob_color *border, struct wob_color *bar);
+
+#endif
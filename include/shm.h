@@ -0,0 +1,189 @@
+#ifndef _WOB_SHM_H
+#define _WOB_SHM_H
+
+// Shared memory input, for producers publishing values at a high rate.
+//
+// The producer maps a sealed memfd holding struct wob_shm and creates an eventfd, then sends both
+// over a connection to wob --socket along with the line "shm" (prefixed by the channel name with
+// --channel). Every value is published under a seqlock and followed by a wakeup of the eventfd,
+// wob then reads the newest consistent snapshot. Values published in between are skipped.
+// The connection is kept open for as long as values are published.
+//
+// Producers define _GNU_SOURCE and include this header, wob_shm_connect() does the setup.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define WOB_SHM_MAGIC 0x316d6873
+
+// background, border and bar colors of the value are applied
+#define WOB_SHM_FLAG_COLORS 0x01
+
+// reader gives up on a region the producer keeps rewriting and waits for the next wakeup
+#define WOB_SHM_READ_ATTEMPTS 16
+
+struct wob_shm {
+	uint32_t magic;
+	// odd while the producer is writing
+	uint32_t sequence;
+	uint32_t value;
+	// colors as 0xAARRGGBB
+	uint32_t background;
+	uint32_t border;
+	uint32_t bar;
+	uint32_t flags;
+};
+
+struct wob_shm_snapshot {
+	uint32_t sequence;
+	uint32_t value;
+	uint32_t background;
+	uint32_t border;
+	uint32_t bar;
+	uint32_t flags;
+};
+
+static inline void
+wob_shm_publish(struct wob_shm *shm, uint32_t value, uint32_t flags, uint32_t background, uint32_t border, uint32_t bar)
+{
+	uint32_t sequence = __atomic_load_n(&shm->sequence, __ATOMIC_RELAXED);
+	__atomic_store_n(&shm->sequence, sequence + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	__atomic_store_n(&shm->value, value, __ATOMIC_RELAXED);
+	__atomic_store_n(&shm->background, background, __ATOMIC_RELAXED);
+	__atomic_store_n(&shm->border, border, __ATOMIC_RELAXED);
+	__atomic_store_n(&shm->bar, bar, __ATOMIC_RELAXED);
+	__atomic_store_n(&shm->flags, flags, __ATOMIC_RELAXED);
+
+	__atomic_store_n(&shm->sequence, sequence + 2, __ATOMIC_RELEASE);
+}
+
+static inline bool
+wob_shm_read(const struct wob_shm *shm, struct wob_shm_snapshot *snapshot)
+{
+	for (int attempt = 0; attempt < WOB_SHM_READ_ATTEMPTS; ++attempt) {
+		uint32_t sequence = __atomic_load_n(&shm->sequence, __ATOMIC_ACQUIRE);
+		if (sequence & 1) {
+			continue;
+		}
+
+		snapshot->value = __atomic_load_n(&shm->value, __ATOMIC_RELAXED);
+		snapshot->background = __atomic_load_n(&shm->background, __ATOMIC_RELAXED);
+		snapshot->border = __atomic_load_n(&shm->border, __ATOMIC_RELAXED);
+		snapshot->bar = __atomic_load_n(&shm->bar, __ATOMIC_RELAXED);
+		snapshot->flags = __atomic_load_n(&shm->flags, __ATOMIC_RELAXED);
+
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		if (__atomic_load_n(&shm->sequence, __ATOMIC_RELAXED) == sequence) {
+			snapshot->sequence = sequence;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+#ifndef WOB_FILE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// returns the connection to wob, which has to stay open, or -1 with errno set
+static inline int
+wob_shm_connect(const char *socket_path, const char *channel, struct wob_shm **shm, int *event_fd)
+{
+	struct sockaddr_un address = {.sun_family = AF_UNIX};
+	char line[256];
+	int length = channel != NULL ? snprintf(line, sizeof(line), "%s shm\n", channel) : snprintf(line, sizeof(line), "shm\n");
+	if (strlen(socket_path) >= sizeof(address.sun_path) || length < 0 || (size_t) length >= sizeof(line)) {
+		errno = ENAMETOOLONG;
+		return -1;
+	}
+	strcpy(address.sun_path, socket_path);
+
+	int memfd = memfd_create("wob-shm", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+	if (memfd == -1) {
+		return -1;
+	}
+
+	// wob refuses regions that could shrink under its mapping
+	if (ftruncate(memfd, sizeof(struct wob_shm)) == -1 || fcntl(memfd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) == -1) {
+		close(memfd);
+		return -1;
+	}
+
+	*shm = mmap(NULL, sizeof(struct wob_shm), PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+	if (*shm == MAP_FAILED) {
+		close(memfd);
+		return -1;
+	}
+	(*shm)->magic = WOB_SHM_MAGIC;
+
+	*event_fd = eventfd(0, EFD_CLOEXEC);
+	int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (*event_fd == -1 || fd == -1 || connect(fd, (struct sockaddr *) &address, sizeof(address)) == -1) {
+		goto error;
+	}
+
+	int fds[2] = {memfd, *event_fd};
+	union {
+		char buffer[CMSG_SPACE(sizeof(fds))];
+		struct cmsghdr align;
+	} control;
+	struct iovec iov = {.iov_base = line, .iov_len = length};
+	struct msghdr message = {
+		.msg_iov = &iov,
+		.msg_iovlen = 1,
+		.msg_control = control.buffer,
+		.msg_controllen = sizeof(control.buffer),
+	};
+	struct cmsghdr *cmsg = CMSG_FIRSTHDR(&message);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+	memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+	if (sendmsg(fd, &message, MSG_NOSIGNAL) != length) {
+		goto error;
+	}
+
+	close(memfd);
+
+	return fd;
+
+error:;
+	int error = errno;
+	if (fd != -1) {
+		close(fd);
+	}
+	if (*event_fd != -1) {
+		close(*event_fd);
+	}
+	munmap(*shm, sizeof(struct wob_shm));
+	close(memfd);
+	errno = error;
+
+	return -1;
+}
+
+// publishes the value and wakes wob up
+static inline bool
+wob_shm_send(struct wob_shm *shm, int event_fd, uint32_t value, uint32_t flags, uint32_t background, uint32_t border, uint32_t bar)
+{
+	wob_shm_publish(shm, value, flags, background, border, bar);
+
+	uint64_t wakeup = 1;
+	return write(event_fd, &wakeup, sizeof(wakeup)) == sizeof(wakeup);
+}
+
+#endif
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef _WOB_SOURCE_H
+#define _WOB_SOURCE_H
+
+#include <stdbool.h>
+
+bool wob_source_read(int fd, long long *value);
+
+bool wob_source_eval(const char *expression, long long value, long long max, long long *result);
+
+#endif
@@ -0,0 +1,159 @@
+#define WOB_FILE "input.c"
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "input.h"
+#include "log.h"
+
+bool
+wob_input_init(struct wob_input *input, int fd)
+{
+	input->fd = fd;
+	input->start = 0;
+	input->length = 0;
+	input->receive_fds = false;
+	input->fd_count = 0;
+	input->buffer[0] = '\0';
+
+	// STDIN shares its file description with the shell, so O_NONBLOCK is never set on it, see wob_input_readable()
+	if (fcntl(fd, F_GETFL) == -1) {
+		wob_log_error("fcntl() failed: %s", strerror(errno));
+		return false;
+	}
+
+	return true;
+}
+
+// every read is gated by poll(), the descriptor may be blocking
+bool
+wob_input_readable(struct wob_input *input)
+{
+	struct pollfd pollfd = {.fd = input->fd, .events = POLLIN};
+	int ready;
+	while ((ready = poll(&pollfd, 1, 0)) == -1 && errno == EINTR) {
+	}
+
+	// errors are reported by the read itself
+	return ready != 0;
+}
+
+ssize_t
+wob_input_receive(struct wob_input *input)
+{
+	union {
+		char buffer[CMSG_SPACE(WOB_INPUT_MAX_FDS * sizeof(int))];
+		struct cmsghdr align;
+	} control;
+	struct iovec iov = {
+		.iov_base = input->buffer + input->length,
+		.iov_len = WOB_INPUT_BUFFER_SIZE - input->length,
+	};
+	struct msghdr message = {
+		.msg_iov = &iov,
+		.msg_iovlen = 1,
+		.msg_control = control.buffer,
+		.msg_controllen = sizeof(control.buffer),
+	};
+
+	ssize_t bytes_read = recvmsg(input->fd, &message, 0);
+	if (bytes_read <= 0) {
+		return bytes_read;
+	}
+
+	for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&message); cmsg != NULL; cmsg = CMSG_NXTHDR(&message, cmsg)) {
+		if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) {
+			continue;
+		}
+
+		size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+		for (size_t i = 0; i < count; ++i) {
+			int fd;
+			memcpy(&fd, CMSG_DATA(cmsg) + i * sizeof(int), sizeof(int));
+			if (input->fd_count == WOB_INPUT_MAX_FDS || fcntl(fd, F_SETFD, FD_CLOEXEC) == -1) {
+				wob_log_error("Dropping descriptor %d received on %d", fd, input->fd);
+				close(fd);
+				continue;
+			}
+
+			input->fds[input->fd_count++] = fd;
+		}
+	}
+
+	return bytes_read;
+}
+
+enum wob_input_status
+wob_input_fill(struct wob_input *input)
+{
+	// move the unfinished trailing line to the front
+	if (input->start > 0) {
+		input->length -= input->start;
+		memmove(input->buffer, input->buffer + input->start, input->length);
+		input->start = 0;
+	}
+
+	if (input->length == WOB_INPUT_BUFFER_SIZE) {
+		wob_log_error("Input line is longer than %d bytes", WOB_INPUT_BUFFER_SIZE);
+		return WOB_INPUT_ERROR;
+	}
+
+	enum wob_input_status status = WOB_INPUT_AGAIN;
+	while (input->length < WOB_INPUT_BUFFER_SIZE && wob_input_readable(input)) {
+		ssize_t bytes_read = input->receive_fds ? wob_input_receive(input) : read(input->fd, input->buffer + input->length, WOB_INPUT_BUFFER_SIZE - input->length);
+		if (bytes_read > 0) {
+			input->length += bytes_read;
+			continue;
+		}
+
+		if (bytes_read == 0) {
+			status = WOB_INPUT_EOF;
+		}
+		else if (errno == EINTR) {
+			continue;
+		}
+		else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+			wob_log_error("read() failed: %s", strerror(errno));
+			status = WOB_INPUT_ERROR;
+		}
+
+		break;
+	}
+
+	input->buffer[input->length] = '\0';
+
+	return status;
+}
+
+char *
+wob_input_next_line(struct wob_input *input)
+{
+	char *line = input->buffer + input->start;
+	char *newline_position = memchr(line, '\n', input->length - input->start);
+	if (newline_position == NULL) {
+		return NULL;
+	}
+
+	input->start = newline_position - input->buffer + 1;
+
+	return line;
+}
+
+const unsigned char *
+wob_input_next_frame(struct wob_input *input, size_t frame_size)
+{
+	if (input->length - input->start < frame_size) {
+		return NULL;
+	}
+
+	const unsigned char *frame = (unsigned char *) input->buffer + input->start;
+	input->start += frame_size;
+
+	return frame;
+}
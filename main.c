@@ -10,36 +10,69 @@
 #define WOB_DEFAULT_MAXIMUM 100
 #define WOB_DEFAULT_TIMEOUT 1000
 
+// buffers needing less drawing than this are not worth handing to a render worker
+#define WOB_PARALLEL_DRAW_MIN_PIXELS (64 * 1024)
+// about a frame at 60 Hz, only used while an animation waits for a step that changes the fill
+#define WOB_ANIMATION_IDLE_MSEC 16
+// single pixel buffers kept for different colors, every output and channel may show colors of its own
+#define WOB_FLAT_CAPACITY 8
+
 #define MIN_PERCENTAGE_BAR_WIDTH 1
 #define MIN_PERCENTAGE_BAR_HEIGHT 1
 
 #define STR(x) #x
 
-// sizeof already includes NULL byte
-#define INPUT_BUFFER_LENGTH (3 * sizeof(unsigned long) + sizeof(" #000000FF #FFFFFFFF #FFFFFFFF\n"))
-
 #define MIN(a, b) (((a) < (b)) ? (a) : (b))
+#define MAX(a, b) (((a) > (b)) ? (a) : (b))
 
-#define STDIN_BUFFER_LENGTH INPUT_BUFFER_LENGTH
+// scales are kept in 1/120 like in wp_fractional_scale_v1
+#define WOB_SCALE_DENOMINATOR 120
 
 #define _POSIX_C_SOURCE 200809L
 #include <errno.h>
+#include <fcntl.h>
 #include <getopt.h>
 #include <limits.h>
+#include <linux/magic.h>
 #include <poll.h>
+#include <pthread.h>
+#include <signal.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/signalfd.h>
+#include <sys/statfs.h>
+#include <sys/timerfd.h>
+#include <time.h>
 #include <unistd.h>
 
+#include "animation.h"
 #include "buffer.h"
 #include "color.h"
+#include "event_loop.h"
+#include "fill.h"
+#include "input.h"
 #include "log.h"
 #include "parse.h"
 #include "pledge.h"
+#include "pool.h"
+#include "queue.h"
+#include "server.h"
+#include "shm.h"
+#include "source.h"
+#include "viewporter-client-protocol.h"
 #include "wlr-layer-shell-unstable-v1-client-protocol.h"
 #include "xdg-output-unstable-v1-client-protocol.h"
+#ifdef WOB_HAVE_SINGLE_PIXEL_BUFFER
+#include "single-pixel-buffer-v1-client-protocol.h"
+#endif
+#ifdef WOB_HAVE_FRACTIONAL_SCALE
+#include "fractional-scale-v1-client-protocol.h"
+#endif
 
 enum wob_overflow_mode {
 	OVERFLOW_MODE_NONE,
@@ -47,6 +80,29 @@ enum wob_overflow_mode {
 	OVERFLOW_MODE_NOWRAP,
 };
 
+enum wob_input_format {
+	INPUT_FORMAT_TEXT,
+	INPUT_FORMAT_BINARY,
+};
+
+enum wob_render_mode {
+	// whole bar in a single buffer
+	RENDER_MODE_FULL,
+	// background and border in the layer surface, bar in a subsurface
+	RENDER_MODE_SPLIT,
+	// like split, with buffers of a single line or pixel scaled by wp_viewporter
+	RENDER_MODE_STRIPS,
+};
+
+enum wob_render_status {
+	// nothing changed, or a ready buffer was committed
+	RENDER_STATUS_DONE,
+	// buffer of the job has to be drawn and committed
+	RENDER_STATUS_DRAW,
+	// buffers are held by compositor
+	RENDER_STATUS_POSTPONED,
+};
+
 struct wob_geom {
 	unsigned long width;
 	unsigned long height;
@@ -65,14 +121,115 @@ struct wob_colors {
 	struct wob_color border;
 };
 
+// colors a profile sets for itself, the others follow command line and input
+#define WOB_PROFILE_BAR_COLOR 0x01
+#define WOB_PROFILE_BACKGROUND_COLOR 0x02
+#define WOB_PROFILE_BORDER_COLOR 0x04
+
+// parts of the geometry a profile sets for itself
+#define WOB_PROFILE_WIDTH 0x01
+#define WOB_PROFILE_HEIGHT 0x02
+#define WOB_PROFILE_BORDER_OFFSET 0x04
+#define WOB_PROFILE_BORDER_SIZE 0x08
+#define WOB_PROFILE_BAR_PADDING 0x10
+#define WOB_PROFILE_ANCHOR 0x20
+#define WOB_PROFILE_MARGIN 0x40
+
+// settings given after the name of an output or a channel, only those in the *_set masks are used
+struct wob_profile {
+	struct wob_geom geom;
+	// width and height in percent of the logical size of the output, 0 when given in pixels
+	unsigned long width_percent;
+	unsigned long height_percent;
+	unsigned int geom_set;
+	struct wob_colors colors;
+	struct wob_colors overflow_colors;
+	unsigned int colors_set;
+	unsigned int overflow_colors_set;
+};
+
+// profile of the bar on outputs matching the name, it takes precedence over the settings of the channel
 struct wob_output_config {
 	char *name;
+	char *settings;
+	struct wl_list link;
+	struct wob_profile profile;
+};
+
+// part of the bar with its own subsurface, the compositor scales its buffer up to the viewport destination
+struct wob_strip {
+	struct wl_surface *wl_surface;
+	struct wl_subsurface *wl_subsurface;
+	struct wp_viewport *wp_viewport;
+};
+
+// buffer of a single color, either single pixel buffer or 1x1 shm buffer
+struct wob_flat {
+	struct wob_buffer_pool pool;
+	struct wob_buffer single_pixels[WOB_FLAT_CAPACITY];
+};
+
+// static layers committed along with the bar, taken by wob_frame_acquire() before the bar is drawn
+struct wob_frame {
+	// background and border of split surfaces
+	struct wob_buffer *buffer;
+	// flat buffers of strip surfaces, only attached once every renderer is drawn
+	struct wob_buffer *flat_background;
+	struct wob_buffer *flat_border;
+};
+
+struct wob_renderer;
+struct wob_channel;
+
+struct wob_draw_job {
+	struct wob_channel *channel;
+	struct wob_renderer *renderer;
+	struct wob_buffer *buffer;
+	struct wob_frame frame;
+	struct wob_contents contents;
+};
+
+// everything drawn at one scale, shared by all surfaces with that scale and look, no matter which channel they belong to
+struct wob_renderer {
 	struct wl_list link;
+	uint32_t scale;
+	// logical geometry and profile with colors of its own, surfaces differing in neither share the renderer
+	struct wob_geom logical_geom;
+	const struct wob_output_config *colors_config;
+	unsigned long references;
+	// geometry in buffer pixels
+	struct wob_geom geom;
+	// geometry of buffers in buffer_pool, whole bar or only its inner part in a subsurface
+	struct wob_geom bar_geom;
+	struct wob_buffer_pool buffer_pool;
+	struct wob_buffer_pool frame_pool;
+	bool frame_atlas;
+	struct wob_atlas atlas;
+	bool buffers_released;
 };
 
 struct wob_surface {
+	struct wl_list link;
+	struct wob *app;
+	struct wob_channel *channel;
+	struct wob_output *output;
+	// logical geometry of the bar on this surface
+	struct wob_geom geom;
+	struct wob_renderer *renderer;
+	// preferred fractional scale, 0 until the compositor sends one
+	uint32_t preferred_scale;
 	struct zwlr_layer_surface_v1 *wlr_layer_surface;
 	struct wl_surface *wl_surface;
+	struct wl_callback *frame_callback;
+	bool configured;
+	struct wob_contents committed;
+#ifdef WOB_HAVE_FRACTIONAL_SCALE
+	struct wp_fractional_scale_v1 *fractional_scale;
+#endif
+	struct wp_viewport *wp_viewport;
+	struct wob_strip border_strip;
+	struct wob_strip inner_strip;
+	struct wob_strip bar_strip;
 };
 
 struct wob_output {
@@ -80,24 +237,157 @@ struct wob_output {
 	struct wl_list link;
 	struct wl_output *wl_output;
 	struct wob *app;
-	struct wob_surface *wob_surface;
 	struct zxdg_output_v1 *xdg_output;
 	uint32_t wl_name;
+	int32_t scale;
+	int32_t logical_width;
+	int32_t logical_height;
+	struct wob_output_config *config;
+};
+
+// bar with its own settings and state, channels share everything else
+struct wob_channel {
+	// NULL for the only channel when none is given on the command line
+	char *name;
+	char *settings;
+	struct wl_list link;
+	struct wob *app;
+	struct wob_geom geom;
+	unsigned long maximum;
+	unsigned long timeout_msec;
+	enum wob_overflow_mode overflow_mode;
+	struct wob_colors colors;
+	struct wob_colors overflow_colors;
+	unsigned long percentage;
+	// fill moving toward percentage, advanced on every frame callback
+	struct wob_animation animation;
+	struct wob_colors effective_colors;
+	bool overflowed;
+	bool hidden;
+	bool dirty;
+	struct timespec hide_deadline;
+	// last value read from input, not applied yet
+	unsigned long received_percentage;
+	bool received;
+	// colors as last parsed by the input thread, it leaves colors to the main thread
+	struct wob_colors input_colors;
+	// surfaces on matching outputs, or the one on the focused output
+	struct wl_list surfaces;
+};
+
+struct wob_listener {
+	struct wl_list link;
+	struct wob *app;
+	// socket bound by wob itself, removed on exit, NULL for sockets passed by the service manager
+	const char *path;
+	struct wob_event_source source;
+};
+
+struct wob_client {
+	struct wl_list link;
+	struct wob *app;
+	struct wob_event_source source;
+	struct wob_input input;
+	// values published through shared memory, see shm.h
+	const struct wob_shm *shm;
+	struct wob_channel *shm_channel;
+	uint32_t shm_sequence;
+	struct wob_event_source shm_source;
+};
+
+// file given with --watch, read again whenever it changes
+struct wob_source {
+	struct wl_list link;
+	struct wob *app;
+	char *path;
+	char *settings;
+	struct wob_channel *channel;
+	// NULL scales the value from 0 to max onto the maximum of the channel
+	const char *expression;
+	long long max;
+	// file the maximum is read from along with every value, NULL for a constant
+	const char *max_path;
+	// inotify watch descriptor, -1 for sysfs attributes
+	int watch;
+	// directory is watched for the file being replaced, which leaves the watch and fd on the old inode
+	int directory_watch;
+	const char *name;
+	// with EPOLLPRI for sysfs attributes, which notify their readers on change
+	struct wob_event_source source;
+	// timerfd for files that never notify, like battery capacity
+	unsigned long interval_msec;
+	struct wob_event_source timer_source;
+	long long last;
+};
+
+struct wob_input_thread {
+	bool started;
+	pthread_t thread;
+	struct wob *app;
+	struct wob_queue queue;
+	// eventfd, input thread wakes up the main thread when it queued updates or stopped
+	struct wob_event_source source;
+	// eventfd, main thread wakes up the input thread when it made room in the queue or wants it to stop
+	int wakeup_fd;
+	// following are accessed atomically
+	bool waiting;
+	bool stop;
+	bool stopped;
+	enum wob_input_status status;
 };
 
 struct wob {
-	int shmid;
-	struct wl_buffer *wl_buffer;
+	struct wl_list channels;
+	// input lines start with the name of the channel
+	bool named_channels;
+	struct wl_list renderers;
+	struct wob_flat flat_background;
+	struct wob_flat flat_border;
 	struct wl_compositor *wl_compositor;
+	struct wl_subcompositor *wl_subcompositor;
+	struct wp_viewporter *wp_viewporter;
+#ifdef WOB_HAVE_SINGLE_PIXEL_BUFFER
+	struct wp_single_pixel_buffer_manager_v1 *single_pixel_buffer_manager;
+#endif
+#ifdef WOB_HAVE_FRACTIONAL_SCALE
+	struct wp_fractional_scale_manager_v1 *fractional_scale_manager;
+#endif
 	struct wl_display *wl_display;
 	struct wl_list wob_outputs;
 	struct wl_list output_configs;
 	struct wl_registry *wl_registry;
 	struct wl_shm *wl_shm;
-	struct wob_geom *wob_geom;
 	struct zwlr_layer_shell_v1 *wlr_layer_shell;
 	struct zxdg_output_manager_v1 *xdg_output_manager;
-	struct wob_surface *fallback_wob_surface;
+	bool persistent_surfaces;
+	bool frame_atlas;
+	bool strip_buffers;
+	enum wob_render_mode render_mode;
+	enum wob_input_format input_format;
+	unsigned long coalesced_inputs;
+	// time animations are drawn at, the same for every output
+	struct timespec render_time;
+	struct wob_event_loop event_loop;
+	struct wob_event_source display_source;
+	struct wob_event_source stdin_source;
+	struct wob_event_source timer_source;
+	struct wob_event_source signal_source;
+	struct wob_input stdin_input;
+	struct wob_pool render_pool;
+	struct wob_draw_job *draw_jobs;
+	size_t draw_job_capacity;
+	bool threaded_input;
+	struct wob_input_thread input_thread;
+	// deadline of a channel changed without a new value, timer has to be armed again
+	bool timer_stale;
+	const char *socket_path;
+	struct wl_list sources;
+	struct wob_event_source inotify_source;
+	struct wl_list listeners;
+	struct wl_list clients;
+	uint32_t display_events;
+	bool running;
+	int exit_status;
 };
 
 void
@@ -109,7 +399,15 @@ noop()
 void
 layer_surface_configure(void *data, struct zwlr_layer_surface_v1 *surface, uint32_t serial, uint32_t w, uint32_t h)
 {
+	struct wob_surface *wob_surface = (struct wob_surface *) data;
+
 	zwlr_layer_surface_v1_ack_configure(surface, serial);
+	wob_surface->configured = true;
+
+	// surface created while the bar is shown missed the last render
+	if (!wob_surface->committed.valid) {
+		wob_surface->channel->dirty = true;
+	}
 }
 
 void
@@ -124,88 +422,591 @@ xdg_output_handle_name(void *data, struct zxdg_output_v1 *xdg_output, const char
 	}
 }
 
+void
+xdg_output_handle_logical_size(void *data, struct zxdg_output_v1 *xdg_output, int32_t width, int32_t height)
+{
+	struct wob_output *output = (struct wob_output *) data;
+
+	output->logical_width = width;
+	output->logical_height = height;
+}
+
+bool
+wob_geom_equal(const struct wob_geom *a, const struct wob_geom *b)
+{
+	if (a->width != b->width || a->height != b->height) {
+		return false;
+	}
+
+	return a->border_offset == b->border_offset && a->border_size == b->border_size && a->bar_padding == b->bar_padding;
+}
+
+// applies the geometry the profile sets, relative sizes are resolved against the logical size of the output when known
+void
+wob_profile_geom(const struct wob_profile *profile, const struct wob_output *output, struct wob_geom *geom)
+{
+	unsigned int set = profile->geom_set;
+	if (set & WOB_PROFILE_BORDER_OFFSET) {
+		geom->border_offset = profile->geom.border_offset;
+	}
+	if (set & WOB_PROFILE_BORDER_SIZE) {
+		geom->border_size = profile->geom.border_size;
+	}
+	if (set & WOB_PROFILE_BAR_PADDING) {
+		geom->bar_padding = profile->geom.bar_padding;
+	}
+	if (set & WOB_PROFILE_ANCHOR) {
+		geom->anchor = profile->geom.anchor;
+	}
+	if (set & WOB_PROFILE_MARGIN) {
+		geom->margin = profile->geom.margin;
+	}
+
+	if ((set & WOB_PROFILE_WIDTH) && profile->width_percent == 0) {
+		geom->width = profile->geom.width;
+	}
+	else if ((set & WOB_PROFILE_WIDTH) && output != NULL && output->logical_width > 0) {
+		geom->width = output->logical_width * profile->width_percent / 100;
+	}
+
+	if ((set & WOB_PROFILE_HEIGHT) && profile->height_percent == 0) {
+		geom->height = profile->geom.height;
+	}
+	else if ((set & WOB_PROFILE_HEIGHT) && output != NULL && output->logical_height > 0) {
+		geom->height = output->logical_height * profile->height_percent / 100;
+	}
+
+	// sizes of one profile may not fit the offsets of the other
+	unsigned long offset_border_padding = geom->border_offset + geom->border_size + geom->bar_padding;
+	geom->width = MAX(geom->width, MIN_PERCENTAGE_BAR_WIDTH + 2 * offset_border_padding);
+	geom->height = MAX(geom->height, MIN_PERCENTAGE_BAR_HEIGHT + 2 * offset_border_padding);
+	geom->stride = geom->width * 4;
+	geom->size = geom->stride * geom->height;
+}
+
+// geometry of the bar of the channel on the output in logical pixels
+void
+wob_output_geom(const struct wob_channel *channel, const struct wob_output *output, struct wob_geom *geom)
+{
+	*geom = channel->geom;
+	if (output != NULL && output->config != NULL) {
+		wob_profile_geom(&output->config->profile, output, geom);
+	}
+}
+
+void
+wob_surface_set_geometry(struct wob_surface *wob_surface, const struct wob_geom *geom)
+{
+	zwlr_layer_surface_v1_set_size(wob_surface->wlr_layer_surface, geom->width, geom->height);
+	zwlr_layer_surface_v1_set_anchor(wob_surface->wlr_layer_surface, geom->anchor);
+	zwlr_layer_surface_v1_set_margin(wob_surface->wlr_layer_surface, geom->margin, geom->margin, geom->margin, geom->margin);
+}
+
+unsigned long
+wob_scale_length(unsigned long length, uint32_t scale)
+{
+	return (length * scale + WOB_SCALE_DENOMINATOR / 2) / WOB_SCALE_DENOMINATOR;
+}
+
+// edges are rounded rather than sizes, so that the parts of the bar still add up to its whole size
+void
+wob_geom_scale(const struct wob_geom *geom, uint32_t scale, struct wob_geom *scaled)
+{
+	unsigned long offset = wob_scale_length(geom->border_offset, scale);
+	unsigned long offset_border = wob_scale_length(geom->border_offset + geom->border_size, scale);
+	unsigned long offset_border_padding = wob_scale_length(geom->border_offset + geom->border_size + geom->bar_padding, scale);
+
+	*scaled = *geom;
+	scaled->border_offset = offset;
+	scaled->border_size = offset_border - offset;
+	scaled->bar_padding = offset_border_padding - offset_border;
+	scaled->width = MAX(wob_scale_length(geom->width, scale), 2 * offset_border_padding + 1);
+	scaled->height = MAX(wob_scale_length(geom->height, scale), 2 * offset_border_padding + 1);
+	scaled->stride = scaled->width * 4;
+	scaled->size = scaled->stride * scaled->height;
+}
+
+struct wob_renderer *
+wob_renderer_get(struct wob *app, uint32_t scale, const struct wob_geom *logical_geom, const struct wob_output_config *colors_config)
+{
+	struct wob_renderer *renderer;
+	wl_list_for_each (renderer, &app->renderers, link) {
+		if (renderer->scale != scale) {
+			continue;
+		}
+
+		if (renderer->colors_config == colors_config && wob_geom_equal(&renderer->logical_geom, logical_geom)) {
+			return renderer;
+		}
+	}
+
+	renderer = calloc(1, sizeof(struct wob_renderer));
+	if (renderer == NULL) {
+		wob_log_error("calloc failed");
+		exit(EXIT_FAILURE);
+	}
+
+	renderer->scale = scale;
+	renderer->logical_geom = *logical_geom;
+	renderer->colors_config = colors_config;
+	wob_geom_scale(logical_geom, scale, &renderer->geom);
+	const struct wob_geom *geom = &renderer->geom;
+	unsigned long offset_border_padding = geom->border_offset + geom->border_size + geom->bar_padding;
+
+	// bar in a subsurface is drawn with all offsets being zero
+	renderer->bar_geom = *geom;
+	if (app->render_mode != RENDER_MODE_FULL) {
+		renderer->bar_geom = (struct wob_geom){
+			.width = geom->width - 2 * offset_border_padding,
+			.height = app->render_mode == RENDER_MODE_STRIPS ? 1 : geom->height - 2 * offset_border_padding,
+		};
+		renderer->bar_geom.stride = renderer->bar_geom.width * 4;
+		renderer->bar_geom.size = renderer->bar_geom.stride * renderer->bar_geom.height;
+	}
+
+	if (!wob_buffer_pool_init(&renderer->buffer_pool, app->wl_shm, renderer->bar_geom.width, renderer->bar_geom.height)) {
+		exit(EXIT_FAILURE);
+	}
+
+	if (app->render_mode == RENDER_MODE_SPLIT) {
+		if (!wob_buffer_pool_init(&renderer->frame_pool, app->wl_shm, geom->width, geom->height)) {
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	renderer->frame_atlas = app->frame_atlas;
+	if (renderer->frame_atlas) {
+		// without subsurfaces frames are whole buffers, background and border are then part of every one of them
+		size_t set_size = renderer->bar_geom.width + 1;
+		size_t set_bytes = set_size * renderer->bar_geom.size;
+		size_t set_count = MIN(WOB_ATLAS_CAPACITY, WOB_ATLAS_MAX_SIZE / set_bytes);
+		if (set_count == 0) {
+			wob_log_warn("Frame atlas would take %zu bytes per set of colors, more than %lu allowed, bar will be drawn on every update", set_bytes, WOB_ATLAS_MAX_SIZE);
+			renderer->frame_atlas = false;
+		}
+		else if (!wob_atlas_init(&renderer->atlas, app->wl_shm, renderer->bar_geom.width, renderer->bar_geom.height, set_size, set_count)) {
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	wob_log_info("Rendering bar at scale %u/%u, %lux%lu buffer pixels", scale, WOB_SCALE_DENOMINATOR, geom->width, geom->height);
+	wl_list_insert(&app->renderers, &renderer->link);
+
+	return renderer;
+}
+
+void
+wob_renderer_destroy(struct wob *app, struct wob_renderer *renderer)
+{
+	wob_buffer_pool_finish(&renderer->buffer_pool);
+	if (app->render_mode == RENDER_MODE_SPLIT) {
+		wob_buffer_pool_finish(&renderer->frame_pool);
+	}
+	if (renderer->frame_atlas) {
+		wob_atlas_finish(&renderer->atlas);
+	}
+
+	wl_list_remove(&renderer->link);
+	free(renderer);
+}
+
+bool
+wob_renderer_used(const struct wob_channel *channel, const struct wob_renderer *renderer)
+{
+	const struct wob_surface *wob_surface;
+	wl_list_for_each (wob_surface, &channel->surfaces, link) {
+		if (wob_surface->renderer == renderer) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// memory of a renderer is only given back once no channel drawn with it is shown
+bool
+wob_renderer_shown(struct wob *app, const struct wob_renderer *renderer)
+{
+	const struct wob_channel *channel;
+	wl_list_for_each (channel, &app->channels, link) {
+		if (!channel->hidden && wob_renderer_used(channel, renderer)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+uint32_t
+wob_surface_scale(struct wob_surface *wob_surface)
+{
+	if (wob_surface->preferred_scale != 0) {
+		return wob_surface->preferred_scale;
+	}
+
+	// without viewport the integer output scale is set with wl_surface.set_buffer_scale, which needs version 3
+	bool buffer_scale = wob_surface->app->wp_viewporter != NULL || wl_surface_get_version(wob_surface->wl_surface) >= WL_SURFACE_SET_BUFFER_SCALE_SINCE_VERSION;
+	if (wob_surface->output == NULL || !buffer_scale) {
+		return WOB_SCALE_DENOMINATOR;
+	}
+
+	return wob_surface->output->scale * WOB_SCALE_DENOMINATOR;
+}
+
+// surfaces of the same scale and profile share a renderer, the one left behind is destroyed by the main loop once compositor releases its buffers
+void
+wob_surface_update_scale(struct wob_surface *wob_surface)
+{
+	struct wob *app = wob_surface->app;
+	uint32_t scale = wob_surface_scale(wob_surface);
+	if (wob_surface->renderer != NULL) {
+		if (wob_surface->renderer->scale == scale) {
+			return;
+		}
+
+		wob_surface->renderer->references -= 1;
+	}
+
+	// profiles with no colors of their own are drawn alike
+	const struct wob_output_config *colors_config = wob_surface->output != NULL ? wob_surface->output->config : NULL;
+	if (colors_config != NULL && colors_config->profile.colors_set == 0 && colors_config->profile.overflow_colors_set == 0) {
+		colors_config = NULL;
+	}
+
+	wob_surface->renderer = wob_renderer_get(app, scale, &wob_surface->geom, colors_config);
+	wob_surface->renderer->references += 1;
+
+	// viewport maps buffers of any size onto the surface, otherwise compositor divides buffer size by the buffer scale
+	if (app->wp_viewporter == NULL && wl_surface_get_version(wob_surface->wl_surface) >= WL_SURFACE_SET_BUFFER_SCALE_SINCE_VERSION) {
+		wl_surface_set_buffer_scale(wob_surface->wl_surface, scale / WOB_SCALE_DENOMINATOR);
+		if (wob_surface->bar_strip.wl_surface != NULL) {
+			wl_surface_set_buffer_scale(wob_surface->bar_strip.wl_surface, scale / WOB_SCALE_DENOMINATOR);
+		}
+	}
+
+	wob_surface->committed.valid = false;
+	wob_surface->channel->dirty = true;
+}
+
+#ifdef WOB_HAVE_FRACTIONAL_SCALE
+void
+wob_surface_handle_preferred_scale(void *data, struct wp_fractional_scale_v1 *fractional_scale, uint32_t scale)
+{
+	struct wob_surface *wob_surface = (struct wob_surface *) data;
+
+	wob_surface->preferred_scale = scale;
+	wob_surface_update_scale(wob_surface);
+}
+#endif
+
+void
+wob_strip_create(struct wob *app, struct wob_strip *strip, struct wl_surface *parent, int32_t x, int32_t y, int32_t width, int32_t height)
+{
+	strip->wl_surface = wl_compositor_create_surface(app->wl_compositor);
+	if (strip->wl_surface == NULL) {
+		wob_log_error("wl_compositor_create_surface failed");
+		exit(EXIT_FAILURE);
+	}
+
+	strip->wl_subsurface = wl_subcompositor_get_subsurface(app->wl_subcompositor, strip->wl_surface, parent);
+	if (strip->wl_subsurface == NULL) {
+		wob_log_error("wl_subcompositor_get_subsurface failed");
+		exit(EXIT_FAILURE);
+	}
+	wl_subsurface_set_position(strip->wl_subsurface, x, y);
+
+	// without viewport, size of the subsurface is the size of its buffer divided by buffer scale
+	if (app->wp_viewporter == NULL) {
+		return;
+	}
+
+	strip->wp_viewport = wp_viewporter_get_viewport(app->wp_viewporter, strip->wl_surface);
+	if (strip->wp_viewport == NULL) {
+		wob_log_error("wp_viewporter_get_viewport failed");
+		exit(EXIT_FAILURE);
+	}
+	wp_viewport_set_destination(strip->wp_viewport, width, height);
+}
+
+void
+wob_strip_destroy(struct wob_strip *strip)
+{
+	if (strip->wl_surface == NULL) {
+		return;
+	}
+
+	if (strip->wp_viewport != NULL) {
+		wp_viewport_destroy(strip->wp_viewport);
+	}
+	wl_subsurface_destroy(strip->wl_subsurface);
+	wl_surface_destroy(strip->wl_surface);
+
+	strip->wp_viewport = NULL;
+	strip->wl_subsurface = NULL;
+	strip->wl_surface = NULL;
+}
+
+// background on the surface itself, then border, background inside of it and bar stacked above in subsurfaces
+void
+wob_surface_create_strips(struct wob *app, struct wob_surface *wob_surface)
+{
+	const struct wob_geom *geom = &wob_surface->geom;
+	unsigned long offset = geom->border_offset;
+	unsigned long offset_border = offset + geom->border_size;
+	unsigned long offset_border_padding = offset_border + geom->bar_padding;
+
+	wob_strip_create(app, &wob_surface->border_strip, wob_surface->wl_surface, offset, offset, geom->width - 2 * offset, geom->height - 2 * offset);
+	wob_strip_create(
+		app, &wob_surface->inner_strip, wob_surface->wl_surface, offset_border, offset_border, geom->width - 2 * offset_border, geom->height - 2 * offset_border);
+	wob_strip_create(
+		app,
+		&wob_surface->bar_strip,
+		wob_surface->wl_surface,
+		offset_border_padding,
+		offset_border_padding,
+		geom->width - 2 * offset_border_padding,
+		geom->height - 2 * offset_border_padding);
+}
+
 struct wob_surface *
-wob_surface_create(struct wob *app, struct wl_output *wl_output)
+wob_surface_create(struct wob_channel *channel, struct wob_output *output)
 {
 	const static struct zwlr_layer_surface_v1_listener zwlr_layer_surface_listener = {
 		.configure = layer_surface_configure,
 		.closed = noop,
 	};
+#ifdef WOB_HAVE_FRACTIONAL_SCALE
+	const static struct wp_fractional_scale_v1_listener fractional_scale_listener = {
+		.preferred_scale = wob_surface_handle_preferred_scale,
+	};
+#endif
 
+	struct wob *app = channel->app;
 	struct wob_surface *wob_surface = calloc(1, sizeof(struct wob_surface));
 	if (wob_surface == NULL) {
 		wob_log_error("calloc failed");
 		exit(EXIT_FAILURE);
 	}
+	wob_surface->app = app;
+	wob_surface->channel = channel;
+	wob_surface->output = output;
+	wob_output_geom(channel, output, &wob_surface->geom);
 
 	wob_surface->wl_surface = wl_compositor_create_surface(app->wl_compositor);
 	if (wob_surface->wl_surface == NULL) {
 		wob_log_error("wl_compositor_create_surface failed");
 		exit(EXIT_FAILURE);
 	}
+	struct wl_output *wl_output = output != NULL ? output->wl_output : NULL;
 	wob_surface->wlr_layer_surface = zwlr_layer_shell_v1_get_layer_surface(app->wlr_layer_shell, wob_surface->wl_surface, wl_output, ZWLR_LAYER_SHELL_V1_LAYER_OVERLAY, "wob");
 	if (wob_surface->wlr_layer_surface == NULL) {
 		wob_log_error("wlr_layer_shell_v1_get_layer_surface failed");
 		exit(EXIT_FAILURE);
 	}
-	zwlr_layer_surface_v1_set_size(wob_surface->wlr_layer_surface, app->wob_geom->width, app->wob_geom->height);
-	zwlr_layer_surface_v1_set_anchor(wob_surface->wlr_layer_surface, app->wob_geom->anchor);
-	zwlr_layer_surface_v1_set_margin(wob_surface->wlr_layer_surface, app->wob_geom->margin, app->wob_geom->margin, app->wob_geom->margin, app->wob_geom->margin);
-	zwlr_layer_surface_v1_add_listener(wob_surface->wlr_layer_surface, &zwlr_layer_surface_listener, app);
+	wob_surface_set_geometry(wob_surface, &wob_surface->geom);
+
+	// buffers are drawn in buffer pixels, viewport maps them back onto the logical size of the surface
+	const struct wob_geom *geom = &wob_surface->geom;
+	if (app->wp_viewporter != NULL) {
+		wob_surface->wp_viewport = wp_viewporter_get_viewport(app->wp_viewporter, wob_surface->wl_surface);
+		if (wob_surface->wp_viewport == NULL) {
+			wob_log_error("wp_viewporter_get_viewport failed");
+			exit(EXIT_FAILURE);
+		}
+		wp_viewport_set_destination(wob_surface->wp_viewport, geom->width, geom->height);
+	}
+
+#ifdef WOB_HAVE_FRACTIONAL_SCALE
+	// fractional scale can only be applied through a viewport
+	if (app->fractional_scale_manager != NULL && app->wp_viewporter != NULL) {
+		wob_surface->fractional_scale = wp_fractional_scale_manager_v1_get_fractional_scale(app->fractional_scale_manager, wob_surface->wl_surface);
+		if (wob_surface->fractional_scale == NULL) {
+			wob_log_error("wp_fractional_scale_manager_v1_get_fractional_scale failed");
+			exit(EXIT_FAILURE);
+		}
+		wp_fractional_scale_v1_add_listener(wob_surface->fractional_scale, &fractional_scale_listener, wob_surface);
+	}
+#endif
+
+	if (app->render_mode == RENDER_MODE_STRIPS) {
+		wob_surface_create_strips(app, wob_surface);
+	}
+	else if (app->render_mode == RENDER_MODE_SPLIT) {
+		unsigned long offset_border_padding = geom->border_offset + geom->border_size + geom->bar_padding;
+		wob_strip_create(
+			app,
+			&wob_surface->bar_strip,
+			wob_surface->wl_surface,
+			offset_border_padding,
+			offset_border_padding,
+			geom->width - 2 * offset_border_padding,
+			geom->height - 2 * offset_border_padding);
+	}
+	wob_surface_update_scale(wob_surface);
+	zwlr_layer_surface_v1_add_listener(wob_surface->wlr_layer_surface, &zwlr_layer_surface_listener, wob_surface);
 	wl_surface_commit(wob_surface->wl_surface);
 
+	wl_list_insert(&channel->surfaces, &wob_surface->link);
+
 	return wob_surface;
 }
 
 void
-wob_surface_destroy(struct wob_surface *wob_surface)
+wob_surface_unmap(struct wob_surface *wob_surface)
 {
-	if (wob_surface == NULL) {
-		return;
+	if (wob_surface->frame_callback != NULL) {
+		wl_callback_destroy(wob_surface->frame_callback);
+		wob_surface->frame_callback = NULL;
 	}
 
+	wl_surface_attach(wob_surface->wl_surface, NULL, 0, 0);
+	wl_surface_commit(wob_surface->wl_surface);
+
+	// unmapped layer surface returns to the state right after it was created, commit it again straight away
+	// so the configure event is already handled by the time the bar is shown again
+	wob_surface->configured = false;
+	wob_surface->committed.valid = false;
+	wob_surface_set_geometry(wob_surface, &wob_surface->geom);
+	wl_surface_commit(wob_surface->wl_surface);
+}
+
+void
+wob_surface_destroy(struct wob_surface *wob_surface)
+{
+	if (wob_surface->frame_callback != NULL) {
+		wl_callback_destroy(wob_surface->frame_callback);
+	}
+	wob_strip_destroy(&wob_surface->bar_strip);
+	wob_strip_destroy(&wob_surface->inner_strip);
+	wob_strip_destroy(&wob_surface->border_strip);
+#ifdef WOB_HAVE_FRACTIONAL_SCALE
+	if (wob_surface->fractional_scale != NULL) {
+		wp_fractional_scale_v1_destroy(wob_surface->fractional_scale);
+		wob_surface->fractional_scale = NULL;
+	}
+#endif
+	if (wob_surface->wp_viewport != NULL) {
+		wp_viewport_destroy(wob_surface->wp_viewport);
+		wob_surface->wp_viewport = NULL;
+	}
+	if (wob_surface->renderer != NULL) {
+		wob_surface->renderer->references -= 1;
+		wob_surface->renderer = NULL;
+	}
 	zwlr_layer_surface_v1_destroy(wob_surface->wlr_layer_surface);
 	wl_surface_destroy(wob_surface->wl_surface);
 
-	wob_surface->wl_surface = NULL;
-	wob_surface->wlr_layer_surface = NULL;
+	wl_list_remove(&wob_surface->link);
+	free(wob_surface);
+}
+
+struct wob_surface *
+wob_channel_surface(struct wob_channel *channel, struct wob_output *output)
+{
+	struct wob_surface *wob_surface;
+	wl_list_for_each (wob_surface, &channel->surfaces, link) {
+		if (wob_surface->output == output) {
+			return wob_surface;
+		}
+	}
+
+	return NULL;
 }
 
 void
 wob_output_destroy(struct wob_output *output)
 {
-	wob_surface_destroy(output->wob_surface);
+	struct wob_channel *channel;
+	wl_list_for_each (channel, &output->app->channels, link) {
+		struct wob_surface *wob_surface = wob_channel_surface(channel, output);
+		if (wob_surface != NULL) {
+			wob_surface_destroy(wob_surface);
+		}
+	}
+
 	zxdg_output_v1_destroy(output->xdg_output);
 	wl_output_destroy(output->wl_output);
 
 	free(output->name);
-	free(output->wob_surface);
 
-	output->wob_surface = NULL;
 	output->wl_output = NULL;
 	output->xdg_output = NULL;
 	output->name = NULL;
 }
 
+// profile given with the exact name of the output takes precedence over '*'
+struct wob_output_config *
+wob_output_config_find(struct wob *app, const char *name)
+{
+	struct wob_output_config *output_config, *any_config = NULL;
+	wl_list_for_each (output_config, &app->output_configs, link) {
+		if (strcmp(name, output_config->name) == 0) {
+			return output_config;
+		}
+		if (strcmp("*", output_config->name) == 0) {
+			any_config = output_config;
+		}
+	}
+
+	return any_config;
+}
+
 void
 xdg_output_handle_done(void *data, struct zxdg_output_v1 *xdg_output)
 {
 	struct wob_output *output = (struct wob_output *) data;
 	struct wob *app = output->app;
 
-	struct wob_output_config *output_config, *tmp;
-	wl_list_for_each_safe (output_config, tmp, &app->output_configs, link) {
-		if (strcmp(output->name, output_config->name) == 0 || strcmp("*", output_config->name) == 0) {
-			wl_list_insert(&output->app->wob_outputs, &output->link);
-			wob_log_info("Bar will be displayed on output %s", output->name);
-			return;
+	// done is sent again whenever the output changes, bar sized relative to the output is then created anew
+	struct wob_channel *channel;
+	if (output->config != NULL) {
+		wl_list_for_each (channel, &app->channels, link) {
+			struct wob_surface *wob_surface = wob_channel_surface(channel, output);
+			struct wob_geom geom;
+			wob_output_geom(channel, output, &geom);
+			if (wob_surface != NULL && !wob_geom_equal(&geom, &wob_surface->geom)) {
+				wob_log_info("Size of output %s changed, bar is resized", output->name);
+				wob_surface_destroy(wob_surface);
+				wob_surface_create(channel, output);
+			}
+		}
+		return;
+	}
+
+	output->config = wob_output_config_find(app, output->name);
+	if (output->config == NULL) {
+		wob_log_info("Bar will NOT be displayed on output %s", output->name);
+
+		wob_output_destroy(output);
+		free(output);
+		return;
+	}
+
+	wl_list_insert(&output->app->wob_outputs, &output->link);
+	wob_log_info("Bar will be displayed on output %s", output->name);
+
+	// outputs known at startup get their persistent surfaces once all globals are bound, see main()
+	if (app->persistent_surfaces && app->running) {
+		wl_list_for_each (channel, &app->channels, link) {
+			wob_surface_create(channel, output);
 		}
 	}
+}
+
+void
+wl_output_handle_scale(void *data, struct wl_output *wl_output, int32_t factor)
+{
+	struct wob_output *output = (struct wob_output *) data;
 
-	wob_log_info("Bar will NOT be displayed on output %s", output->name);
+	output->scale = factor;
 
-	wob_output_destroy(output);
-	free(output);
+	struct wob_channel *channel;
+	wl_list_for_each (channel, &output->app->channels, link) {
+		struct wob_surface *wob_surface = wob_channel_surface(channel, output);
+		if (wob_surface != NULL) {
+			wob_surface_update_scale(wob_surface);
+		}
+	}
 }
 
 void
@@ -213,11 +1014,17 @@ handle_global(void *data, struct wl_registry *registry, uint32_t name, const cha
 {
 	const static struct zxdg_output_v1_listener xdg_output_listener = {
 		.logical_position = noop,
-		.logical_size = noop,
+		.logical_size = xdg_output_handle_logical_size,
 		.name = xdg_output_handle_name,
 		.description = noop,
 		.done = xdg_output_handle_done,
 	};
+	const static struct wl_output_listener wl_output_listener = {
+		.geometry = noop,
+		.mode = noop,
+		.done = noop,
+		.scale = wl_output_handle_scale,
+	};
 
 	struct wob *app = (struct wob *) data;
 
@@ -225,14 +1032,18 @@ handle_global(void *data, struct wl_registry *registry, uint32_t name, const cha
 		app->wl_shm = wl_registry_bind(registry, name, &wl_shm_interface, 1);
 	}
 	else if (strcmp(interface, wl_compositor_interface.name) == 0) {
-		app->wl_compositor = wl_registry_bind(registry, name, &wl_compositor_interface, 1);
+		// wl_surface.damage_buffer needs version 4, older compositors get the whole surface damaged
+		app->wl_compositor = wl_registry_bind(registry, name, &wl_compositor_interface, version < 4 ? version : 4);
 	}
 	else if (strcmp(interface, "wl_output") == 0) {
 		if (!wl_list_empty(&(app->output_configs))) {
 			struct wob_output *output = calloc(1, sizeof(struct wob_output));
-			output->wl_output = wl_registry_bind(registry, name, &wl_output_interface, 1);
+			// wl_output.scale needs version 2
+			output->wl_output = wl_registry_bind(registry, name, &wl_output_interface, version < 2 ? version : 2);
 			output->app = app;
 			output->wl_name = name;
+			output->scale = 1;
+			wl_output_add_listener(output->wl_output, &wl_output_listener, output);
 
 			output->xdg_output = zxdg_output_manager_v1_get_xdg_output(app->xdg_output_manager, output->wl_output);
 			zxdg_output_v1_add_listener(output->xdg_output, &xdg_output_listener, output);
@@ -249,6 +1060,22 @@ handle_global(void *data, struct wl_registry *registry, uint32_t name, const cha
 	else if (strcmp(interface, zxdg_output_manager_v1_interface.name) == 0) {
 		app->xdg_output_manager = wl_registry_bind(registry, name, &zxdg_output_manager_v1_interface, 2);
 	}
+	else if (strcmp(interface, wl_subcompositor_interface.name) == 0) {
+		app->wl_subcompositor = wl_registry_bind(registry, name, &wl_subcompositor_interface, 1);
+	}
+	else if (strcmp(interface, wp_viewporter_interface.name) == 0) {
+		app->wp_viewporter = wl_registry_bind(registry, name, &wp_viewporter_interface, 1);
+	}
+#ifdef WOB_HAVE_SINGLE_PIXEL_BUFFER
+	else if (strcmp(interface, wp_single_pixel_buffer_manager_v1_interface.name) == 0) {
+		app->single_pixel_buffer_manager = wl_registry_bind(registry, name, &wp_single_pixel_buffer_manager_v1_interface, 1);
+	}
+#endif
+#ifdef WOB_HAVE_FRACTIONAL_SCALE
+	else if (strcmp(interface, wp_fractional_scale_manager_v1_interface.name) == 0) {
+		app->fractional_scale_manager = wl_registry_bind(registry, name, &wp_fractional_scale_manager_v1_interface, 1);
+	}
+#endif
 }
 
 void
@@ -265,219 +1092,2369 @@ handle_global_remove(void *data, struct wl_registry *registry, uint32_t name)
 }
 
 void
-wob_flush(struct wob *app)
+wob_surface_handle_frame_done(void *data, struct wl_callback *wl_callback, uint32_t time)
+{
+	struct wob_surface *wob_surface = (struct wob_surface *) data;
+
+	wl_callback_destroy(wl_callback);
+	wob_surface->frame_callback = NULL;
+}
+
+// returns false when the contents are already shown, otherwise the changed rectangle in buffer coordinates
+bool
+wob_contents_damage(const struct wob_geom *geom, const struct wob_contents *old, const struct wob_contents *new, int32_t damage[4])
+{
+	if (old->valid && old->background == new->background && old->border == new->border) {
+		// a new bar color means the whole colored part changed
+		unsigned long start = old->bar != new->bar ? 0 : MIN(old->bar_width, new->bar_width);
+		unsigned long end = MAX(old->bar_width, new->bar_width);
+
+		if (start == end) {
+			return false;
+		}
+
+		unsigned long offset_border_padding = geom->border_offset + geom->border_size + geom->bar_padding;
+		damage[0] = offset_border_padding + start;
+		damage[1] = offset_border_padding;
+		damage[2] = end - start;
+		damage[3] = geom->height - 2 * offset_border_padding;
+		return true;
+	}
+
+	damage[0] = 0;
+	damage[1] = 0;
+	damage[2] = geom->width;
+	damage[3] = geom->height;
+	return true;
+}
+
+void
+wob_surface_damage(struct wl_surface *wl_surface, const int32_t damage[4])
+{
+	if (wl_surface_get_version(wl_surface) >= WL_SURFACE_DAMAGE_BUFFER_SINCE_VERSION) {
+		wl_surface_damage_buffer(wl_surface, damage[0], damage[1], damage[2], damage[3]);
+	}
+	else {
+		wl_surface_damage(wl_surface, 0, 0, INT32_MAX, INT32_MAX);
+	}
+}
+
+void
+wob_surface_commit(struct wob_surface *wob_surface)
+{
+	const static struct wl_callback_listener wl_callback_listener = {
+		.done = wob_surface_handle_frame_done,
+	};
+
+	if (wob_surface->frame_callback == NULL) {
+		wob_surface->frame_callback = wl_surface_frame(wob_surface->wl_surface);
+		wl_callback_add_listener(wob_surface->frame_callback, &wl_callback_listener, wob_surface);
+	}
+	wl_surface_commit(wob_surface->wl_surface);
+}
+
+void
+wob_strip_commit(struct wob_strip *strip, struct wob_buffer *buffer, const int32_t damage[4])
+{
+	wl_surface_attach(strip->wl_surface, buffer->wl_buffer, 0, 0);
+	wob_surface_damage(strip->wl_surface, damage);
+	wl_surface_commit(strip->wl_surface);
+
+	buffer->busy = true;
+}
+
+// subsurfaces are synchronized, their new state shows up atomically with the commit of the layer surface
+void
+wob_surface_flush_layers(struct wob *app, struct wob_surface *wob_surface, const struct wob_frame *frame, struct wob_buffer *buffer)
+{
+	struct wob_renderer *renderer = wob_surface->renderer;
+	const struct wob_contents *committed = &wob_surface->committed;
+	const int32_t whole_damage[4] = {0, 0, INT32_MAX, INT32_MAX};
+
+	int32_t damage[4];
+	if (!wob_contents_damage(&renderer->bar_geom, committed, &buffer->contents, damage)) {
+		return;
+	}
+
+	bool background_changed = !committed->valid || committed->background != buffer->contents.background;
+	bool border_changed = !committed->valid || committed->border != buffer->contents.border;
+
+	struct wob_buffer *layer = frame->buffer;
+	if (app->render_mode == RENDER_MODE_STRIPS) {
+		if (border_changed) {
+			wob_strip_commit(&wob_surface->border_strip, frame->flat_border, whole_damage);
+		}
+		if (background_changed) {
+			wob_strip_commit(&wob_surface->inner_strip, frame->flat_background, whole_damage);
+		}
+		layer = frame->flat_background;
+	}
+
+	wob_strip_commit(&wob_surface->bar_strip, buffer, damage);
+
+	// layer surface itself is only attached again when background or border changed
+	if (background_changed || border_changed) {
+		wl_surface_attach(wob_surface->wl_surface, layer->wl_buffer, 0, 0);
+		wob_surface_damage(wob_surface->wl_surface, whole_damage);
+		layer->busy = true;
+	}
+	wob_surface_commit(wob_surface);
+
+	wob_surface->committed = buffer->contents;
+}
+
+void
+wob_surface_flush(struct wob *app, struct wob_surface *wob_surface, const struct wob_frame *frame, struct wob_buffer *buffer)
+{
+	// buffers can only be attached once the surface is configured, it is drawn again then
+	if (!wob_surface->configured) {
+		return;
+	}
+
+	if (app->render_mode != RENDER_MODE_FULL) {
+		wob_surface_flush_layers(app, wob_surface, frame, buffer);
+		return;
+	}
+
+	int32_t damage[4];
+	if (!wob_contents_damage(&wob_surface->renderer->geom, &wob_surface->committed, &buffer->contents, damage)) {
+		return;
+	}
+
+	wl_surface_attach(wob_surface->wl_surface, buffer->wl_buffer, 0, 0);
+	wob_surface_damage(wob_surface->wl_surface, damage);
+	wob_surface_commit(wob_surface);
+
+	wob_surface->committed = buffer->contents;
+}
+
+bool
+wob_surface_shows(struct wob_surface *wob_surface, struct wob_renderer *renderer, const struct wob_contents *contents)
+{
+	if (wob_surface->renderer != renderer) {
+		return true;
+	}
+
+	const struct wob_contents *committed = &wob_surface->committed;
+	if (!committed->valid || committed->bar_width != contents->bar_width) {
+		return false;
+	}
+
+	return committed->bar == contents->bar && committed->background == contents->background && committed->border == contents->border;
+}
+
+// whether every surface of the channel drawn by the renderer already shows the contents
+bool
+wob_contents_shown(struct wob_channel *channel, struct wob_renderer *renderer, const struct wob_contents *contents)
+{
+	struct wob_surface *wob_surface;
+	wl_list_for_each (wob_surface, &channel->surfaces, link) {
+		if (!wob_surface_shows(wob_surface, renderer, contents)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void
+wob_flush(struct wob *app, struct wob_channel *channel, struct wob_renderer *renderer, const struct wob_frame *frame, struct wob_buffer *buffer)
+{
+	struct wob_surface *wob_surface;
+	wl_list_for_each (wob_surface, &channel->surfaces, link) {
+		if (wob_surface->renderer == renderer) {
+			wob_surface_flush(app, wob_surface, frame, buffer);
+		}
+	}
+
+	// compositor now holds the buffer until it sends wl_buffer.release
+	buffer->busy = true;
+}
+
+bool
+wob_frame_pending(struct wob_channel *channel)
+{
+	// the fastest output paces rendering, an output that stopped sending frame events (e.g. turned off) must not block the others
+	struct wob_surface *wob_surface;
+	wl_list_for_each (wob_surface, &channel->surfaces, link) {
+		if (wob_surface->frame_callback == NULL) {
+			return false;
+		}
+	}
+
+	return !wl_list_empty(&channel->surfaces);
+}
+
+void
+wob_hide(struct wob_channel *channel)
+{
+	struct wob *app = channel->app;
+
+	struct wob_surface *wob_surface, *tmp;
+	wl_list_for_each_safe (wob_surface, tmp, &channel->surfaces, link) {
+		if (wob_surface->output == NULL) {
+			wob_log_info("Hiding bar on focused output");
+		}
+		else {
+			wob_log_info("Hiding bar on output %s", wob_surface->output->name);
+		}
+
+		if (app->persistent_surfaces) {
+			wob_surface_unmap(wob_surface);
+		}
+		else {
+			wob_surface_destroy(wob_surface);
+		}
+	}
+
+	if (app->persistent_surfaces) {
+		if (wl_display_flush(app->wl_display) == -1 && errno != EAGAIN) {
+			wob_log_error("wl_display_flush failed");
+			exit(EXIT_FAILURE);
+		}
+
+		return;
+	}
+
+	if (wl_display_roundtrip(app->wl_display) == -1) {
+		wob_log_error("wl_display_roundtrip failed");
+		exit(EXIT_FAILURE);
+	}
+}
+
+bool
+wob_surfaces_configured(struct wob_channel *channel)
+{
+	struct wob_surface *wob_surface;
+	wl_list_for_each (wob_surface, &channel->surfaces, link) {
+		if (!wob_surface->configured) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void
+wob_show(struct wob_channel *channel)
 {
+	struct wob *app = channel->app;
 
 	if (wl_list_empty(&(app->wob_outputs))) {
-		wl_surface_attach(app->fallback_wob_surface->wl_surface, app->wl_buffer, 0, 0);
-		wl_surface_damage(app->fallback_wob_surface->wl_surface, 0, 0, app->wob_geom->width, app->wob_geom->height);
-		wl_surface_commit(app->fallback_wob_surface->wl_surface);
+		wob_log_info("No output matching configuration found, fallbacking to focused output");
+		if (wl_list_empty(&channel->surfaces)) {
+			wob_surface_create(channel, NULL);
+		}
 	}
 	else {
+		// surface on the focused output is no longer needed once a matching output appeared
+		struct wob_surface *fallback_wob_surface = wob_channel_surface(channel, NULL);
+		if (fallback_wob_surface != NULL) {
+			wob_surface_destroy(fallback_wob_surface);
+		}
+
 		struct wob_output *output, *tmp;
-		wl_list_for_each_safe (output, tmp, &(app->wob_outputs), link) {
-			wl_surface_attach(output->wob_surface->wl_surface, app->wl_buffer, 0, 0);
-			wl_surface_damage(output->wob_surface->wl_surface, 0, 0, app->wob_geom->width, app->wob_geom->height);
-			wl_surface_commit(output->wob_surface->wl_surface);
+		wl_list_for_each_safe (output, tmp, &app->wob_outputs, link) {
+			wob_log_info("Showing bar on output %s", output->name);
+			if (wob_channel_surface(channel, output) == NULL) {
+				wob_surface_create(channel, output);
+			}
+		}
+	}
+
+	// persistent surfaces have normally been configured while hidden, the bar is then shown by a single commit
+	if (wob_surfaces_configured(channel)) {
+		return;
+	}
+
+	if (wl_display_roundtrip(app->wl_display) == -1) {
+		wob_log_error("wl_display_roundtrip failed");
+		exit(EXIT_FAILURE);
+	}
+}
+
+// buffer of one color shared by every renderer, busy from the moment it is acquired so that no other renderer of the same pass replaces it
+struct wob_buffer *
+wob_flat_acquire(struct wob *app, struct wob_flat *flat, uint32_t argb)
+{
+	struct wob_buffer *buffers = flat->pool.buffers;
+	size_t count = flat->pool.count;
+#ifdef WOB_HAVE_SINGLE_PIXEL_BUFFER
+	if (app->single_pixel_buffer_manager != NULL) {
+		buffers = flat->single_pixels;
+		count = WOB_FLAT_CAPACITY;
+	}
+#endif
+
+	// contents of a flat buffer never change while compositor may hold it, so it is attached again as it is
+	for (size_t i = 0; i < count; ++i) {
+		if (buffers[i].contents.valid && buffers[i].contents.background == argb) {
+			buffers[i].busy = true;
+			return &buffers[i];
+		}
+	}
+
+	struct wob_buffer *buffer = NULL;
+#ifdef WOB_HAVE_SINGLE_PIXEL_BUFFER
+	if (app->single_pixel_buffer_manager != NULL) {
+		for (size_t i = 0; i < count && buffer == NULL; ++i) {
+			if (!buffers[i].busy) {
+				buffer = &buffers[i];
+			}
+		}
+
+		if (buffer == NULL) {
+			return NULL;
+		}
+
+		if (buffer->wl_buffer != NULL) {
+			wl_buffer_destroy(buffer->wl_buffer);
+		}
+
+		// 8-bit channel value c is c / 255 * UINT32_MAX in protocol units
+		buffer->wl_buffer = wp_single_pixel_buffer_manager_v1_create_u32_rgba_buffer(
+			app->single_pixel_buffer_manager,
+			((argb >> 16) & 0xFF) * 0x01010101U,
+			((argb >> 8) & 0xFF) * 0x01010101U,
+			(argb & 0xFF) * 0x01010101U,
+			((argb >> 24) & 0xFF) * 0x01010101U);
+		wob_buffer_listen(buffer);
+	}
+#endif
+
+	if (buffer == NULL) {
+		buffer = wob_buffer_pool_acquire(&flat->pool);
+		if (buffer == NULL) {
+			return NULL;
+		}
+		buffer->argb[0] = argb;
+	}
+
+	buffer->contents = (struct wob_contents){.valid = true, .background = argb};
+	buffer->busy = true;
+
+	return buffer;
+}
+
+void
+wob_flat_finish(struct wob_flat *flat)
+{
+	for (size_t i = 0; i < WOB_FLAT_CAPACITY; ++i) {
+		if (flat->single_pixels[i].wl_buffer != NULL) {
+			wl_buffer_destroy(flat->single_pixels[i].wl_buffer);
+			flat->single_pixels[i].wl_buffer = NULL;
+		}
+	}
+
+	if (flat->pool.wl_shm_pool != NULL) {
+		wob_buffer_pool_finish(&flat->pool);
+	}
+}
+
+void
+wob_destroy(struct wob *app)
+{
+	struct wob_output *output, *output_tmp;
+	wl_list_for_each_safe (output, output_tmp, &app->wob_outputs, link) {
+		wob_output_destroy(output);
+		free(output);
+	}
+
+	struct wob_output_config *config, *config_tmp;
+	wl_list_for_each_safe (config, config_tmp, &app->output_configs, link) {
+		free(config->name);
+		free(config);
+	}
+
+	struct wob_channel *channel, *channel_tmp;
+	wl_list_for_each_safe (channel, channel_tmp, &app->channels, link) {
+		struct wob_surface *wob_surface, *wob_surface_tmp;
+		wl_list_for_each_safe (wob_surface, wob_surface_tmp, &channel->surfaces, link) {
+			wob_surface_destroy(wob_surface);
+		}
+
+		free(channel->name);
+		free(channel);
+	}
+
+	zwlr_layer_shell_v1_destroy(app->wlr_layer_shell);
+	wl_registry_destroy(app->wl_registry);
+	struct wob_renderer *renderer, *renderer_tmp;
+	wl_list_for_each_safe (renderer, renderer_tmp, &app->renderers, link) {
+		wob_renderer_destroy(app, renderer);
+	}
+	if (app->render_mode == RENDER_MODE_STRIPS) {
+		wob_flat_finish(&app->flat_background);
+		wob_flat_finish(&app->flat_border);
+	}
+	wl_compositor_destroy(app->wl_compositor);
+	wl_shm_destroy(app->wl_shm);
+	zxdg_output_manager_v1_destroy(app->xdg_output_manager);
+	if (app->wl_subcompositor != NULL) {
+		wl_subcompositor_destroy(app->wl_subcompositor);
+	}
+	if (app->wp_viewporter != NULL) {
+		wp_viewporter_destroy(app->wp_viewporter);
+	}
+#ifdef WOB_HAVE_SINGLE_PIXEL_BUFFER
+	if (app->single_pixel_buffer_manager != NULL) {
+		wp_single_pixel_buffer_manager_v1_destroy(app->single_pixel_buffer_manager);
+	}
+#endif
+#ifdef WOB_HAVE_FRACTIONAL_SCALE
+	if (app->fractional_scale_manager != NULL) {
+		wp_fractional_scale_manager_v1_destroy(app->fractional_scale_manager);
+	}
+#endif
+
+	wl_display_disconnect(app->wl_display);
+
+	struct wob_client *client, *client_tmp;
+	wl_list_for_each_safe (client, client_tmp, &app->clients, link) {
+		if (client->shm != NULL) {
+			close(client->shm_source.fd);
+			wob_server_unmap_shm(client->shm);
+		}
+		close(client->source.fd);
+		free(client);
+	}
+
+	struct wob_listener *listener, *listener_tmp;
+	wl_list_for_each_safe (listener, listener_tmp, &app->listeners, link) {
+		close(listener->source.fd);
+		if (listener->path != NULL && unlink(listener->path) == -1) {
+			wob_log_warn("Cannot remove socket %s: %s", listener->path, strerror(errno));
 		}
+		free(listener);
+	}
+
+	struct wob_source *source, *source_tmp;
+	wl_list_for_each_safe (source, source_tmp, &app->sources, link) {
+		if (source->source.fd != -1) {
+			close(source->source.fd);
+		}
+		if (source->timer_source.fd != -1) {
+			close(source->timer_source.fd);
+		}
+		free(source->path);
+		free(source);
+	}
+	if (app->inotify_source.fd != -1) {
+		close(app->inotify_source.fd);
+	}
+
+	wob_pool_finish(&app->render_pool);
+	free(app->draw_jobs);
+
+	close(app->timer_source.fd);
+	close(app->signal_source.fd);
+	wob_event_loop_finish(&app->event_loop);
+}
+
+unsigned long
+wob_bar_colored_width(const struct wob_geom *geom, unsigned long percentage, unsigned long maximum)
+{
+	size_t offset_border_padding = geom->border_offset + geom->border_size + geom->bar_padding;
+	size_t bar_width = geom->width - 2 * offset_border_padding;
+
+	return (bar_width * percentage) / maximum;
+}
+
+unsigned long
+wob_bar_animated_width(const struct wob_geom *geom, const struct wob_channel *channel, const struct timespec *now)
+{
+	if (!channel->animation.running || wob_animation_finished(&channel->animation, now)) {
+		return wob_bar_colored_width(geom, channel->percentage, channel->maximum);
+	}
+
+	size_t offset_border_padding = geom->border_offset + geom->border_size + geom->bar_padding;
+	size_t bar_width = geom->width - 2 * offset_border_padding;
+
+	return bar_width * wob_animation_position(&channel->animation, now);
+}
+
+void
+wob_connect(struct wob *app)
+{
+	const static struct wl_registry_listener wl_registry_listener = {
+		.global = handle_global,
+		.global_remove = noop,
+	};
+
+	app->wl_display = wl_display_connect(NULL);
+	if (app->wl_display == NULL) {
+		wob_log_error("wl_display_connect failed");
+		exit(EXIT_FAILURE);
+	}
+
+	app->wl_registry = wl_display_get_registry(app->wl_display);
+	if (app->wl_registry == NULL) {
+		wob_log_error("wl_display_get_registry failed");
+		exit(EXIT_FAILURE);
+	}
+
+	wl_registry_add_listener(app->wl_registry, &wl_registry_listener, app);
+
+	wl_list_init(&app->wob_outputs);
+	wl_list_init(&app->renderers);
+	if (wl_display_roundtrip(app->wl_display) == -1) {
+		wob_log_error("wl_display_roundtrip failed");
+		exit(EXIT_FAILURE);
+	}
+
+	if (app->wl_shm == NULL) {
+		return;
+	}
+
+	if (app->strip_buffers && (app->wl_subcompositor == NULL || app->wp_viewporter == NULL)) {
+		wob_log_warn("Compositor does not support wl_subcompositor and wp_viewporter, strip buffers are not used");
+	}
+
+	// buffers of every scale are created along with the first surface of that scale, see wob_renderer_get()
+	app->render_mode = RENDER_MODE_FULL;
+	if (app->wl_subcompositor != NULL) {
+		app->render_mode = app->strip_buffers && app->wp_viewporter != NULL ? RENDER_MODE_STRIPS : RENDER_MODE_SPLIT;
+	}
+
+	if (app->render_mode == RENDER_MODE_STRIPS) {
+#ifdef WOB_HAVE_SINGLE_PIXEL_BUFFER
+		bool flat_pools = app->single_pixel_buffer_manager == NULL;
+#else
+		bool flat_pools = true;
+#endif
+		if (flat_pools && (!wob_buffer_pool_init(&app->flat_background.pool, app->wl_shm, 1, 1) || !wob_buffer_pool_init(&app->flat_border.pool, app->wl_shm, 1, 1))) {
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	if (app->frame_atlas && app->render_mode == RENDER_MODE_STRIPS) {
+		wob_log_info("Strip buffers are used, frame atlas is not needed");
+		app->frame_atlas = false;
+	}
+}
+
+void
+wob_draw_background(const struct wob_geom *geom, uint32_t *argb, uint32_t argb_color)
+{
+	wob_fill(argb, argb_color, geom->width * geom->height);
+}
+
+void
+wob_draw_border(const struct wob_geom *geom, uint32_t *argb, uint32_t argb_color)
+{
+	// create top and bottom line
+	size_t line_width = geom->width - 2 * geom->border_offset;
+	wob_fill_rect(&argb[geom->width * geom->border_offset + geom->border_offset], geom->width, line_width, geom->border_size, argb_color);
+	wob_fill_rect(&argb[geom->width * (geom->height - geom->border_offset - geom->border_size) + geom->border_offset], geom->width, line_width, geom->border_size, argb_color);
+
+	// create left and right horizontal line
+	size_t line_height = geom->height - 2 * (geom->border_size + geom->border_offset);
+	uint32_t *first_line = &argb[geom->width * (geom->border_offset + geom->border_size)];
+	wob_fill_rect(first_line + geom->border_offset, geom->width, geom->border_size, line_height, argb_color);
+	wob_fill_rect(first_line + geom->width - geom->border_offset - geom->border_size, geom->width, geom->border_size, line_height, argb_color);
+}
+
+void
+wob_draw_bar(const struct wob_geom *geom, uint32_t *argb, uint32_t argb_color, unsigned long start, unsigned long end)
+{
+	size_t offset_border_padding = geom->border_offset + geom->border_size + geom->bar_padding;
+	size_t bar_height = geom->height - 2 * offset_border_padding;
+
+	// draw columns [start, end) of the first bar line and copy the span to the rest of the bar lines
+	uint32_t *line = &argb[offset_border_padding * (geom->width + 1)];
+	wob_fill(line + start, argb_color, end - start);
+	wob_replicate_row(line + start, geom->width, end - start, bar_height);
+}
+
+void
+wob_draw_percentage(const struct wob_geom *geom, struct wob_buffer *buffer, const struct wob_contents *contents)
+{
+	struct wob_contents *drawn = &buffer->contents;
+
+	// every buffer keeps its own contents, background and border only need to be drawn when they are stale
+	if (!drawn->valid || drawn->background != contents->background || drawn->border != contents->border) {
+		wob_draw_background(geom, buffer->argb, contents->background);
+		wob_draw_border(geom, buffer->argb, contents->border);
+		drawn->valid = true;
+		drawn->background = contents->background;
+		drawn->border = contents->border;
+		drawn->bar = contents->bar;
+		drawn->bar_width = 0;
+	}
+
+	// only columns between the old and the new fill change, unless bar color changed too
+	if (drawn->bar != contents->bar) {
+		wob_draw_bar(geom, buffer->argb, contents->bar, 0, MIN(drawn->bar_width, contents->bar_width));
+	}
+
+	if (contents->bar_width > drawn->bar_width) {
+		wob_draw_bar(geom, buffer->argb, contents->bar, drawn->bar_width, contents->bar_width);
+	}
+	else if (contents->bar_width < drawn->bar_width) {
+		wob_draw_bar(geom, buffer->argb, contents->background, contents->bar_width, drawn->bar_width);
+	}
+
+	*drawn = *contents;
+}
+
+// pixels wob_draw_percentage() is going to touch
+size_t
+wob_draw_cost(const struct wob_geom *geom, const struct wob_buffer *buffer, const struct wob_contents *contents)
+{
+	const struct wob_contents *drawn = &buffer->contents;
+	if (!drawn->valid || drawn->background != contents->background || drawn->border != contents->border) {
+		return geom->width * geom->height;
+	}
+
+	size_t offset_border_padding = geom->border_offset + geom->border_size + geom->bar_padding;
+	size_t columns;
+	if (drawn->bar != contents->bar) {
+		columns = MAX(drawn->bar_width, contents->bar_width);
+	}
+	else {
+		columns = MAX(drawn->bar_width, contents->bar_width) - MIN(drawn->bar_width, contents->bar_width);
+	}
+
+	return columns * (geom->height - 2 * offset_border_padding);
+}
+
+// frame of the atlas showing the contents, it still has to be drawn when it is not valid
+struct wob_buffer *
+wob_atlas_frame(struct wob_renderer *renderer, const struct wob_contents *contents)
+{
+	struct wob_atlas *atlas = &renderer->atlas;
+
+	for (size_t i = 0; i < atlas->set_count; ++i) {
+		const struct wob_contents *set_colors = &atlas->set_colors[i];
+		if (set_colors->valid && set_colors->bar == contents->bar && set_colors->background == contents->background && set_colors->border == contents->border) {
+			atlas->current = i;
+			return &wob_atlas_set(atlas, i)[contents->bar_width];
+		}
+	}
+
+	// colors changed, give a set the compositor no longer holds to the new ones, the one used last goes only when there is no other
+	for (size_t j = 1; j <= atlas->set_count; ++j) {
+		size_t i = (atlas->current + j) % atlas->set_count;
+		if (wob_atlas_set_busy(atlas, i)) {
+			continue;
+		}
+
+		struct wob_buffer *frames = wob_atlas_set(atlas, i);
+		for (size_t k = 0; k < atlas->set_size; ++k) {
+			frames[k].contents.valid = false;
+		}
+		atlas->set_colors[i] = *contents;
+		atlas->current = i;
+		return &frames[contents->bar_width];
+	}
+
+	return NULL;
+}
+
+// static layer of split surfaces, bar area is left transparent for the bar subsurface
+void
+wob_draw_frame(const struct wob_geom *geom, struct wob_buffer *buffer, const struct wob_contents *contents)
+{
+	size_t offset_border_padding = geom->border_offset + geom->border_size + geom->bar_padding;
+
+	wob_draw_background(geom, buffer->argb, contents->background);
+	wob_draw_border(geom, buffer->argb, contents->border);
+	wob_fill_rect(
+		&buffer->argb[offset_border_padding * (geom->width + 1)], geom->width, geom->width - 2 * offset_border_padding, geom->height - 2 * offset_border_padding, 0);
+
+	buffer->contents = (struct wob_contents){.valid = true, .background = contents->background, .border = contents->border};
+}
+
+bool
+wob_frame_acquire(struct wob *app, struct wob_renderer *renderer, const struct wob_contents *contents, struct wob_frame *frame)
+{
+	*frame = (struct wob_frame){0};
+	if (app->render_mode == RENDER_MODE_STRIPS) {
+		frame->flat_background = wob_flat_acquire(app, &app->flat_background, contents->background);
+		frame->flat_border = wob_flat_acquire(app, &app->flat_border, contents->border);
+		return frame->flat_background != NULL && frame->flat_border != NULL;
+	}
+
+	if (app->render_mode != RENDER_MODE_SPLIT) {
+		return true;
+	}
+
+	// frame showing the right colors is attached again even while compositor holds it, it is never drawn into then
+	struct wob_buffer_pool *pool = &renderer->frame_pool;
+	for (size_t i = 0; i < pool->count; ++i) {
+		const struct wob_contents *drawn = &pool->buffers[i].contents;
+		if (drawn->valid && drawn->background == contents->background && drawn->border == contents->border) {
+			frame->buffer = &pool->buffers[i];
+			return true;
+		}
+	}
+
+	frame->buffer = wob_buffer_pool_acquire(pool);
+	if (frame->buffer == NULL) {
+		return false;
+	}
+
+	// like flat buffers busy from the moment it is drawn, a channel with other colors drawn in the same pass takes another one
+	wob_draw_frame(&renderer->geom, frame->buffer, contents);
+	frame->buffer->busy = true;
+
+	return true;
+}
+
+void
+wob_profile_colors_apply(struct wob_colors *colors, const struct wob_colors *profile_colors, unsigned int colors_set)
+{
+	if (colors_set & WOB_PROFILE_BAR_COLOR) {
+		colors->bar = profile_colors->bar;
+	}
+	if (colors_set & WOB_PROFILE_BACKGROUND_COLOR) {
+		colors->background = profile_colors->background;
+	}
+	if (colors_set & WOB_PROFILE_BORDER_COLOR) {
+		colors->border = profile_colors->border;
+	}
+}
+
+// returns false when drawing has to wait for the compositor to release some buffers
+// buffers are drawn later by wob_render(), possibly on a render worker
+enum wob_render_status
+wob_renderer_render(struct wob *app, struct wob_channel *channel, struct wob_renderer *renderer, struct wob_draw_job *job)
+{
+	// colors given in the profile take precedence over those from command line and input
+	struct wob_colors colors = channel->effective_colors;
+	const struct wob_output_config *config = renderer->colors_config;
+	if (config != NULL) {
+		if (channel->overflowed) {
+			wob_profile_colors_apply(&colors, &config->profile.overflow_colors, config->profile.overflow_colors_set);
+		}
+		else {
+			wob_profile_colors_apply(&colors, &config->profile.colors, config->profile.colors_set);
+		}
+	}
+
+	struct wob_contents contents = {
+		.valid = true,
+		.bar_width = wob_bar_animated_width(&renderer->geom, channel, &app->render_time),
+		.bar = colors.bar.argb,
+		.background = colors.background.argb,
+		.border = colors.border.argb,
+	};
+
+	// nothing visible changed, skip drawing and committing altogether
+	if (wob_contents_shown(channel, renderer, &contents)) {
+		return RENDER_STATUS_DONE;
+	}
+	renderer->buffers_released = false;
+
+	// background and border of split surfaces are in buffers of their own
+	struct wob_frame frame;
+	if (!wob_frame_acquire(app, renderer, &contents, &frame)) {
+		wob_log_debug("All frame buffers are held by compositor, postponing render");
+		return RENDER_STATUS_POSTPONED;
+	}
+
+	// with the atlas an update is only a matter of attaching the right frame, once that frame was shown before
+	struct wob_buffer *buffer = NULL;
+	if (renderer->frame_atlas) {
+		buffer = wob_atlas_frame(renderer, &contents);
+		if (buffer == NULL) {
+			wob_log_debug("All atlas sets are held by compositor, drawing into buffer pool");
+		}
+		else if (buffer->contents.valid) {
+			wob_flush(app, channel, renderer, &frame, buffer);
+			return RENDER_STATUS_DONE;
+		}
+	}
+
+	// frame of the atlas shown for the first time is drawn like any buffer of the pool
+	if (buffer == NULL) {
+		buffer = wob_buffer_pool_acquire(&renderer->buffer_pool);
+		if (buffer == NULL) {
+			if (renderer->buffer_pool.count < WOB_BUFFER_POOL_CAPACITY) {
+				exit(EXIT_FAILURE);
+			}
+
+			wob_log_debug("All buffers are held by compositor, postponing render");
+			return RENDER_STATUS_POSTPONED;
+		}
+	}
+
+	*job = (struct wob_draw_job){
+		.channel = channel,
+		.renderer = renderer,
+		.buffer = buffer,
+		.frame = frame,
+		.contents = contents,
+	};
+
+	return RENDER_STATUS_DRAW;
+}
+
+void
+wob_draw_job_run(void *data, size_t index)
+{
+	struct wob_draw_job *job = (struct wob_draw_job *) data + index;
+	wob_draw_percentage(&job->renderer->bar_geom, job->buffer, &job->contents);
+}
+
+// draws every channel that is ready for a new frame, buffers of different outputs may be drawn in parallel
+void
+wob_render(struct wob *app)
+{
+	// channels sharing a renderer are drawn with it one after another, each into a buffer of its own
+	size_t job_capacity = wl_list_length(&app->renderers) * wl_list_length(&app->channels);
+	if (job_capacity > app->draw_job_capacity) {
+		struct wob_draw_job *draw_jobs = realloc(app->draw_jobs, job_capacity * sizeof(struct wob_draw_job));
+		if (draw_jobs == NULL) {
+			wob_log_error("realloc failed");
+			return;
+		}
+
+		app->draw_jobs = draw_jobs;
+		app->draw_job_capacity = job_capacity;
+	}
+
+	if (clock_gettime(CLOCK_MONOTONIC, &app->render_time) != 0) {
+		wob_log_error("clock_gettime() failed: %s", strerror(errno));
+		return;
+	}
+
+	size_t job_count = 0;
+	size_t large_jobs = 0;
+	struct wob_channel *channel;
+	wl_list_for_each (channel, &app->channels, link) {
+		// render at most once per frame, wl_surface.frame tells us when the compositor is ready for a new one
+		if (channel->hidden || !channel->dirty || wob_frame_pending(channel)) {
+			continue;
+		}
+
+		// every renderer of the channel is drawn once, no matter how many of its surfaces show it
+		bool rendered = true;
+		struct wob_renderer *renderer;
+		wl_list_for_each (renderer, &app->renderers, link) {
+			if (!wob_renderer_used(channel, renderer)) {
+				continue;
+			}
+
+			struct wob_draw_job *job = &app->draw_jobs[job_count];
+			switch (wob_renderer_render(app, channel, renderer, job)) {
+				case RENDER_STATUS_DONE:
+					break;
+				case RENDER_STATUS_DRAW:
+					job_count += 1;
+					if (wob_draw_cost(&renderer->bar_geom, job->buffer, &job->contents) >= WOB_PARALLEL_DRAW_MIN_PIXELS) {
+						large_jobs += 1;
+					}
+					break;
+				case RENDER_STATUS_POSTPONED:
+					rendered = false;
+					break;
+			}
+		}
+
+		if (channel->animation.running && wob_animation_finished(&channel->animation, &app->render_time)) {
+			channel->animation.running = false;
+		}
+
+		// stays dirty, main loop tries again after wl_buffer.release is received
+		// or the next frame callback, as long as the animation has not reached the value yet
+		channel->dirty = !rendered || channel->animation.running;
+	}
+
+	// workers only pay off with more than one large buffer, small bars are drawn right here
+	if (large_jobs > 1 && app->render_pool.max_workers > 0) {
+		wob_pool_run(&app->render_pool, wob_draw_job_run, app->draw_jobs, job_count);
+	}
+	else {
+		for (size_t i = 0; i < job_count; ++i) {
+			wob_draw_job_run(app->draw_jobs, i);
+		}
+	}
+
+	// Wayland requests are only ever made from this thread
+	for (size_t i = 0; i < job_count; ++i) {
+		struct wob_draw_job *job = &app->draw_jobs[i];
+		wob_flush(app, job->channel, job->renderer, &job->frame, job->buffer);
+	}
+}
+
+// a step of an animation too small to change a single column commits nothing, no frame callback then asks for the next one
+int
+wob_render_timeout(struct wob *app)
+{
+	struct wob_channel *channel;
+	wl_list_for_each (channel, &app->channels, link) {
+		if (!channel->hidden && channel->animation.running && !wob_frame_pending(channel)) {
+			return WOB_ANIMATION_IDLE_MSEC;
+		}
+	}
+
+	return -1;
+}
+
+void
+wob_quit(struct wob *app, int exit_status)
+{
+	app->exit_status = exit_status;
+	app->running = false;
+}
+
+// single timer serves all channels, it expires at the earliest deadline of the shown ones
+bool
+wob_timer_arm(struct wob *app)
+{
+	struct itimerspec timer = {0};
+	bool armed = false;
+
+	struct wob_channel *channel;
+	wl_list_for_each (channel, &app->channels, link) {
+		if (channel->hidden) {
+			continue;
+		}
+
+		const struct timespec *deadline = &channel->hide_deadline;
+		if (!armed || deadline->tv_sec < timer.it_value.tv_sec || (deadline->tv_sec == timer.it_value.tv_sec && deadline->tv_nsec < timer.it_value.tv_nsec)) {
+			timer.it_value = *deadline;
+			armed = true;
+		}
+	}
+
+	// zero value disarms the timer
+	if (timerfd_settime(app->timer_source.fd, TFD_TIMER_ABSTIME, &timer, NULL) == -1) {
+		wob_log_error("timerfd_settime() failed: %s", strerror(errno));
+		return false;
+	}
+
+	return true;
+}
+
+void
+wob_hide_now(struct wob_channel *channel)
+{
+	if (!channel->hidden) {
+		wob_hide(channel);
+	}
+
+	channel->hidden = true;
+	channel->dirty = false;
+}
+
+// the caller arms the timer
+bool
+wob_refresh_timeout(struct wob_channel *channel)
+{
+	// deadline is absolute, wakeups unrelated to input do not postpone hiding the bar
+	if (clock_gettime(CLOCK_MONOTONIC, &channel->hide_deadline) != 0) {
+		wob_log_error("clock_gettime() failed: %s", strerror(errno));
+		return false;
+	}
+	channel->hide_deadline.tv_sec += channel->timeout_msec / 1000;
+	channel->hide_deadline.tv_nsec += (channel->timeout_msec % 1000) * 1000000L;
+	if (channel->hide_deadline.tv_nsec >= 1000000000L) {
+		channel->hide_deadline.tv_sec += 1;
+		channel->hide_deadline.tv_nsec -= 1000000000L;
+	}
+
+	return true;
+}
+
+bool
+wob_apply_value(struct wob_channel *channel, unsigned long percentage)
+{
+	struct wob *app = channel->app;
+	struct wob_colors effective_colors = channel->colors;
+	bool overflowed = percentage > channel->maximum;
+	if (overflowed) {
+		switch (channel->overflow_mode) {
+			case OVERFLOW_MODE_NONE:
+				wob_log_error("Received value %ld is above defined maximum %ld", percentage, channel->maximum);
+				return false;
+			case OVERFLOW_MODE_WRAP:
+				effective_colors = channel->overflow_colors;
+				percentage %= channel->maximum;
+				break;
+			case OVERFLOW_MODE_NOWRAP:
+				effective_colors = channel->overflow_colors;
+				percentage = channel->maximum;
+				break;
+		}
+	}
+
+	wob_log_info(
+		"Received input { channel = %s, value = %ld, bg = %#x, border = %#x, bar = %#x, overflow = %s }",
+		channel->name != NULL ? channel->name : "default",
+		percentage,
+		effective_colors.background.argb,
+		effective_colors.border.argb,
+		effective_colors.bar.argb,
+		channel->overflow_mode == OVERFLOW_MODE_NONE ? "false" : "true"); // how should this be handled w/ the overflow colors?
+
+	struct timespec now;
+	if (clock_gettime(CLOCK_MONOTONIC, &now) != 0) {
+		wob_log_error("clock_gettime() failed: %s", strerror(errno));
+		return false;
+	}
+
+	// a hidden bar shows up with the value right away, only changes of a shown one are animated
+	double fraction = (double) percentage / channel->maximum;
+	if (channel->hidden) {
+		wob_animation_jump(&channel->animation, fraction);
+		wob_show(channel);
+		channel->hidden = false;
+	}
+	else {
+		wob_animation_start(&channel->animation, fraction, &now);
+	}
+
+	// input arriving faster than the compositor presents frames is folded into the latest value
+	if (channel->dirty) {
+		app->coalesced_inputs += 1;
+		wob_log_debug("Coalesced input, %lu inputs coalesced so far", app->coalesced_inputs);
+	}
+
+	channel->percentage = percentage;
+	channel->effective_colors = effective_colors;
+	channel->overflowed = overflowed;
+	channel->dirty = true;
+
+	return wob_refresh_timeout(channel);
+}
+
+void
+wob_handle_display(struct wob_event_source *source, uint32_t events)
+{
+	struct wob *app = wl_container_of(source, app, display_source);
+
+	if (events & EPOLLIN) {
+		if (wl_display_prepare_read(app->wl_display) == 0 && wl_display_read_events(app->wl_display) == -1) {
+			wob_log_error("wl_display_read_events failed");
+			exit(EXIT_FAILURE);
+		}
+
+		if (wl_display_dispatch_pending(app->wl_display) == -1) {
+			wob_log_error("wl_display_dispatch_pending failed");
+			exit(EXIT_FAILURE);
+		}
+	}
+	else if (events & (EPOLLERR | EPOLLHUP)) {
+		wob_log_error("WL_DISPLAY_FD unexpectedly closed, events = %#x", events);
+		exit(EXIT_FAILURE);
+	}
+}
+
+// input line of a named channel starts with its name followed by a space
+struct wob_channel *
+wob_channel_find(struct wob *app, char **line)
+{
+	char *separator = strchr(*line, ' ');
+	if (separator == NULL) {
+		return NULL;
+	}
+	*separator = '\0';
+
+	struct wob_channel *channel;
+	wl_list_for_each (channel, &app->channels, link) {
+		if (strcmp(channel->name, *line) == 0) {
+			*line = separator + 1;
+			return channel;
+		}
+	}
+
+	return NULL;
+}
+
+// absolute values are only kept until wob_apply_received(), the last one wins, other commands act on them right away
+bool
+wob_receive(struct wob_channel *channel, enum wob_command command, unsigned long value)
+{
+	if (command == WOB_COMMAND_SET) {
+		// values coalesced away are still checked, input above the maximum is an error like it always was
+		if (channel->overflow_mode == OVERFLOW_MODE_NONE && value > channel->maximum) {
+			wob_log_error("Received value %ld is above defined maximum %ld", value, channel->maximum);
+			return false;
+		}
+
+		// the pending value is replaced before it ever reaches wob_apply_value(), count it here
+		if (channel->received) {
+			channel->app->coalesced_inputs += 1;
+			wob_log_debug("Coalesced input, %lu inputs coalesced so far", channel->app->coalesced_inputs);
+		}
+
+		channel->received_percentage = value;
+		channel->received = true;
+		return true;
+	}
+
+	if (channel->received) {
+		channel->received = false;
+		if (!wob_apply_value(channel, channel->received_percentage)) {
+			return false;
+		}
+	}
+	channel->app->timer_stale = true;
+
+	switch (command) {
+		case WOB_COMMAND_INCREASE:
+			// going past the maximum overflows like an absolute value would, unless overflows are not allowed
+			value = channel->percentage > ULONG_MAX - value ? ULONG_MAX : channel->percentage + value;
+			if (channel->overflow_mode == OVERFLOW_MODE_NONE) {
+				value = MIN(value, channel->maximum);
+			}
+			return wob_apply_value(channel, value);
+		case WOB_COMMAND_DECREASE:
+			return wob_apply_value(channel, channel->percentage > value ? channel->percentage - value : 0);
+		case WOB_COMMAND_SHOW:
+			if (channel->hidden) {
+				wob_show(channel);
+				channel->hidden = false;
+				channel->dirty = true;
+			}
+			return wob_refresh_timeout(channel);
+		case WOB_COMMAND_HIDE:
+			wob_hide_now(channel);
+			return true;
+		case WOB_COMMAND_REFRESH_TIMEOUT:
+			return channel->hidden || wob_refresh_timeout(channel);
+		case WOB_COMMAND_SET:
+			break;
+	}
+
+	return true;
+}
+
+// queues the update for the main thread, waits while the queue is full
+bool
+wob_input_thread_push(struct wob_input_thread *thread, const struct wob_update *update)
+{
+	uint64_t wakeup = 1;
+	while (!wob_queue_push(&thread->queue, update)) {
+		__atomic_store_n(&thread->waiting, true, __ATOMIC_SEQ_CST);
+		if (wob_queue_push(&thread->queue, update)) {
+			break;
+		}
+
+		// main thread has to drain the queue before there is room again
+		if (write(thread->source.fd, &wakeup, sizeof(wakeup)) != sizeof(wakeup)) {
+			wob_log_error("write() to eventfd failed: %s", strerror(errno));
+			return false;
+		}
+
+		struct pollfd pollfd = {.fd = thread->wakeup_fd, .events = POLLIN};
+		if (poll(&pollfd, 1, -1) == -1 && errno != EINTR) {
+			wob_log_error("poll() failed: %s", strerror(errno));
+			return false;
+		}
+
+		uint64_t wakeups;
+		if (read(thread->wakeup_fd, &wakeups, sizeof(wakeups)) != sizeof(wakeups) && errno != EAGAIN) {
+			wob_log_error("read() from eventfd failed: %s", strerror(errno));
+			return false;
+		}
+
+		if (__atomic_load_n(&thread->stop, __ATOMIC_ACQUIRE)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// parses every complete line or frame buffered in input, values are applied by wob_apply_received()
+// on the input thread they are queued for the main thread instead
+bool
+wob_parse_pending(struct wob *app, struct wob_input *input, struct wob_input_thread *thread)
+{
+	// without named channels there is just one
+	struct wob_channel *channel = wl_container_of(app->channels.next, channel, link);
+	struct wob_colors *colors;
+	enum wob_command command;
+	unsigned long percentage;
+	const unsigned char *frame;
+	char *line;
+	while (true) {
+		switch (app->input_format) {
+			case INPUT_FORMAT_TEXT:
+				if ((line = wob_input_next_line(input)) == NULL) {
+					return true;
+				}
+
+				if (app->named_channels && (channel = wob_channel_find(app, &line)) == NULL) {
+					wob_log_error("Received input for unknown channel");
+					return false;
+				}
+
+				colors = thread != NULL ? &channel->input_colors : &channel->colors;
+				if (!wob_parse_command(line, &command, &percentage, &colors->background, &colors->border, &colors->bar)) {
+					wob_log_error("Received invalid input");
+					return false;
+				}
+				break;
+			case INPUT_FORMAT_BINARY:
+				if ((frame = wob_input_next_frame(input, WOB_BINARY_INPUT_FRAME_SIZE)) == NULL) {
+					return true;
+				}
+
+				colors = thread != NULL ? &channel->input_colors : &channel->colors;
+				if (!wob_parse_binary_input(frame, &command, &percentage, &colors->background, &colors->border, &colors->bar)) {
+					wob_log_error("Received invalid input frame");
+					return false;
+				}
+				break;
+		}
+
+		if (thread == NULL) {
+			if (!wob_receive(channel, command, percentage)) {
+				return false;
+			}
+			continue;
+		}
+
+		struct wob_update update = {
+			.channel = channel,
+			.command = command,
+			.percentage = percentage,
+			.background = colors->background,
+			.border = colors->border,
+			.bar = colors->bar,
+		};
+		if (!wob_input_thread_push(thread, &update)) {
+			return false;
+		}
+	}
+}
+
+// only the last value parsed for every channel is rendered
+bool
+wob_apply_received(struct wob *app)
+{
+	bool received = false;
+	struct wob_channel *channel;
+	wl_list_for_each (channel, &app->channels, link) {
+		if (!channel->received) {
+			continue;
+		}
+
+		channel->received = false;
+		received = true;
+		if (!wob_apply_value(channel, channel->received_percentage)) {
+			return false;
+		}
+	}
+
+	if ((received || app->timer_stale) && !wob_timer_arm(app)) {
+		return false;
+	}
+	app->timer_stale = false;
+
+	return true;
+}
+
+void
+wob_handle_stdin(struct wob_event_source *source, uint32_t events)
+{
+	struct wob *app = wl_container_of(source, app, stdin_source);
+
+	if (events & EPOLLERR) {
+		wob_log_error("STDIN unexpectedly closed, events = %#x", events);
+		wob_quit(app, EXIT_FAILURE);
+		return;
+	}
+
+	// drain everything the producer has written so far, lines are parsed in place and only the last value is rendered
+	enum wob_input_status status = wob_input_fill(&app->stdin_input);
+
+	if (!wob_parse_pending(app, &app->stdin_input, NULL) || !wob_apply_received(app)) {
+		wob_quit(app, EXIT_FAILURE);
+		return;
+	}
+
+	switch (status) {
+		case WOB_INPUT_AGAIN:
+			break;
+		case WOB_INPUT_EOF:
+			wob_log_info("Received EOF, %lu inputs were coalesced", app->coalesced_inputs);
+			wob_quit(app, EXIT_SUCCESS);
+			break;
+		case WOB_INPUT_ERROR:
+			wob_quit(app, EXIT_FAILURE);
+			break;
+	}
+}
+
+void *
+wob_input_thread_run(void *data)
+{
+	struct wob_input_thread *thread = data;
+	struct wob *app = thread->app;
+
+	struct pollfd pollfds[2] = {
+		{.fd = STDIN_FILENO, .events = POLLIN},
+		{.fd = thread->wakeup_fd, .events = POLLIN},
+	};
+	enum wob_input_status status = WOB_INPUT_AGAIN;
+	uint64_t wakeup = 1;
+	while (status == WOB_INPUT_AGAIN && !__atomic_load_n(&thread->stop, __ATOMIC_ACQUIRE)) {
+		if (poll(pollfds, 2, -1) == -1) {
+			if (errno == EINTR) {
+				continue;
+			}
+
+			wob_log_error("poll() failed: %s", strerror(errno));
+			status = WOB_INPUT_ERROR;
+			break;
+		}
+
+		if (pollfds[1].revents) {
+			uint64_t wakeups;
+			if (read(thread->wakeup_fd, &wakeups, sizeof(wakeups)) != sizeof(wakeups) && errno != EAGAIN) {
+				wob_log_error("read() from eventfd failed: %s", strerror(errno));
+				status = WOB_INPUT_ERROR;
+				break;
+			}
+		}
+
+		if (!pollfds[0].revents) {
+			continue;
+		}
+
+		status = wob_input_fill(&app->stdin_input);
+		if (!wob_parse_pending(app, &app->stdin_input, thread)) {
+			status = WOB_INPUT_ERROR;
+		}
+
+		// one wakeup for everything parsed in this round
+		if (write(thread->source.fd, &wakeup, sizeof(wakeup)) != sizeof(wakeup)) {
+			wob_log_error("write() to eventfd failed: %s", strerror(errno));
+			status = WOB_INPUT_ERROR;
+		}
+	}
+
+	thread->status = status;
+	__atomic_store_n(&thread->stopped, true, __ATOMIC_RELEASE);
+	if (write(thread->source.fd, &wakeup, sizeof(wakeup)) != sizeof(wakeup)) {
+		wob_log_error("write() to eventfd failed: %s", strerror(errno));
+	}
+
+	return NULL;
+}
+
+void
+wob_handle_input_thread(struct wob_event_source *source, uint32_t events)
+{
+	struct wob_input_thread *thread = wl_container_of(source, thread, source);
+	struct wob *app = thread->app;
+
+	uint64_t wakeups;
+	if (read(source->fd, &wakeups, sizeof(wakeups)) != sizeof(wakeups) && errno != EAGAIN) {
+		wob_log_error("read() from eventfd failed: %s", strerror(errno));
+		wob_quit(app, EXIT_FAILURE);
+		return;
+	}
+
+	// checked before draining, everything queued before the thread stopped is still applied
+	bool stopped = __atomic_load_n(&thread->stopped, __ATOMIC_ACQUIRE);
+
+	struct wob_update update;
+	while (wob_queue_pop(&thread->queue, &update)) {
+		struct wob_channel *channel = update.channel;
+		channel->colors.background = update.background;
+		channel->colors.border = update.border;
+		channel->colors.bar = update.bar;
+		if (!wob_receive(channel, update.command, update.percentage)) {
+			wob_quit(app, EXIT_FAILURE);
+			return;
+		}
+	}
+
+	uint64_t wakeup = 1;
+	if (__atomic_exchange_n(&thread->waiting, false, __ATOMIC_SEQ_CST) && write(thread->wakeup_fd, &wakeup, sizeof(wakeup)) != sizeof(wakeup)) {
+		wob_log_error("write() to eventfd failed: %s", strerror(errno));
+		wob_quit(app, EXIT_FAILURE);
+		return;
+	}
+
+	if (!wob_apply_received(app)) {
+		wob_quit(app, EXIT_FAILURE);
+		return;
+	}
+
+	if (!stopped) {
+		return;
+	}
+
+	switch (thread->status) {
+		case WOB_INPUT_EOF:
+			wob_log_info("Received EOF, %lu inputs were coalesced", app->coalesced_inputs);
+			wob_quit(app, EXIT_SUCCESS);
+			break;
+		default:
+			wob_quit(app, EXIT_FAILURE);
+			break;
+	}
+}
+
+bool
+wob_input_thread_start(struct wob *app)
+{
+	struct wob_input_thread *thread = &app->input_thread;
+	thread->app = app;
+	wob_queue_init(&thread->queue);
+
+	thread->source = (struct wob_event_source){
+		.fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK),
+		.handle = wob_handle_input_thread,
+	};
+	thread->wakeup_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (thread->source.fd == -1 || thread->wakeup_fd == -1) {
+		wob_log_error("eventfd() failed: %s", strerror(errno));
+		return false;
+	}
+
+	if (!wob_event_loop_add(&app->event_loop, &thread->source, EPOLLIN)) {
+		return false;
+	}
+
+	struct wob_channel *channel;
+	wl_list_for_each (channel, &app->channels, link) {
+		channel->input_colors = channel->colors;
+	}
+
+	// signals stay blocked in the new thread, they are only ever read from signalfd
+	int error = pthread_create(&thread->thread, NULL, wob_input_thread_run, thread);
+	if (error != 0) {
+		wob_log_error("pthread_create() failed: %s", strerror(error));
+		return false;
+	}
+	thread->started = true;
+
+	return true;
+}
+
+void
+wob_input_thread_stop(struct wob_input_thread *thread)
+{
+	if (thread->started) {
+		uint64_t wakeup = 1;
+		__atomic_store_n(&thread->stop, true, __ATOMIC_RELEASE);
+		if (write(thread->wakeup_fd, &wakeup, sizeof(wakeup)) != sizeof(wakeup)) {
+			wob_log_error("write() to eventfd failed: %s", strerror(errno));
+		}
+		pthread_join(thread->thread, NULL);
+		thread->started = false;
+	}
+
+	if (thread->source.fd != -1) {
+		close(thread->source.fd);
+	}
+	if (thread->wakeup_fd != -1) {
+		close(thread->wakeup_fd);
+	}
+}
+
+void
+wob_client_destroy(struct wob_client *client)
+{
+	wob_log_debug("Client %d disconnected", client->source.fd);
+
+	if (client->shm != NULL) {
+		wob_event_loop_remove(&client->app->event_loop, &client->shm_source);
+		close(client->shm_source.fd);
+		wob_server_unmap_shm(client->shm);
+	}
+
+	for (size_t i = 0; i < client->input.fd_count; ++i) {
+		close(client->input.fds[i]);
+	}
+
+	wob_event_loop_remove(&client->app->event_loop, &client->source);
+	close(client->source.fd);
+	wl_list_remove(&client->link);
+	free(client);
+}
+
+void
+wob_handle_shm(struct wob_event_source *source, uint32_t events)
+{
+	struct wob_client *client = wl_container_of(source, client, shm_source);
+	struct wob_channel *channel = client->shm_channel;
+
+	// any number of wakeups since the last one is just a hint to look at the region
+	uint64_t wakeups;
+	if (read(source->fd, &wakeups, sizeof(wakeups)) != sizeof(wakeups) && errno != EAGAIN) {
+		wob_log_error("read() from eventfd failed: %s", strerror(errno));
+		wob_client_destroy(client);
+		return;
+	}
+
+	struct wob_shm_snapshot snapshot;
+	if (!wob_shm_read(client->shm, &snapshot) || snapshot.sequence == client->shm_sequence) {
+		return;
+	}
+	client->shm_sequence = snapshot.sequence;
+
+	// checked like values of text clients before its colors are taken, a bad one only costs the producer its connection
+	if (!wob_receive(channel, WOB_COMMAND_SET, snapshot.value)) {
+		wob_client_destroy(client);
+		return;
+	}
+	if (snapshot.flags & WOB_SHM_FLAG_COLORS) {
+		wob_server_shm_colors(&snapshot, &channel->colors.background, &channel->colors.border, &channel->colors.bar);
+	}
+
+	if (!wob_apply_received(client->app)) {
+		wob_quit(client->app, EXIT_FAILURE);
+	}
+}
+
+// the descriptors come along with the line "shm", the first one sent over the connection
+bool
+wob_client_attach_shm(struct wob_client *client)
+{
+	struct wob *app = client->app;
+	struct wob_input *input = &client->input;
+
+	struct wob_channel *channel = wl_container_of(app->channels.next, channel, link);
+	char *line = wob_input_next_line(input);
+	if (client->shm != NULL || input->fd_count != 2 || line == NULL || (app->named_channels && (channel = wob_channel_find(app, &line)) == NULL) ||
+		strcmp(line, "shm\n") != 0) {
+		wob_log_error("Received descriptors without a valid shm request");
+		return false;
+	}
+
+	client->shm = wob_server_map_shm(input->fds[0]);
+	close(input->fds[0]);
+	client->shm_source = (struct wob_event_source){
+		.fd = input->fds[1],
+		.handle = wob_handle_shm,
+	};
+	input->fd_count = 0;
+	if (client->shm == NULL) {
+		close(client->shm_source.fd);
+		return false;
+	}
+
+	int flags = fcntl(client->shm_source.fd, F_GETFL);
+	if (flags == -1 || fcntl(client->shm_source.fd, F_SETFL, flags | O_NONBLOCK) == -1 || !wob_event_loop_add(&app->event_loop, &client->shm_source, EPOLLIN)) {
+		close(client->shm_source.fd);
+		wob_server_unmap_shm(client->shm);
+		client->shm = NULL;
+		return false;
+	}
+
+	client->shm_channel = channel;
+	client->shm_sequence = 0;
+	wob_log_info("Client %d publishes values through shared memory", client->source.fd);
+
+	return true;
+}
+
+void
+wob_handle_client(struct wob_event_source *source, uint32_t events)
+{
+	struct wob_client *client = wl_container_of(source, client, source);
+	struct wob *app = client->app;
+
+	enum wob_input_status status = wob_input_fill(&client->input);
+	if (client->input.fd_count > 0 && !wob_client_attach_shm(client)) {
+		wob_client_destroy(client);
+		return;
+	}
+
+	// a misbehaving client only loses its own connection, values it sent before stay applied
+	bool valid = wob_parse_pending(app, &client->input, NULL);
+	if (!wob_apply_received(app)) {
+		wob_quit(app, EXIT_FAILURE);
+		return;
+	}
+
+	if (!valid || status != WOB_INPUT_AGAIN) {
+		wob_client_destroy(client);
+	}
+}
+
+void
+wob_handle_listener(struct wob_event_source *source, uint32_t events)
+{
+	struct wob_listener *listener = wl_container_of(source, listener, source);
+	struct wob *app = listener->app;
+
+	int fd;
+	while ((fd = wob_server_accept(source->fd)) != -1) {
+		struct wob_client *client = calloc(1, sizeof(struct wob_client));
+		if (client == NULL) {
+			wob_log_error("calloc failed");
+			close(fd);
+			return;
+		}
+
+		client->app = app;
+		client->source = (struct wob_event_source){
+			.fd = fd,
+			.handle = wob_handle_client,
+		};
+		bool initialized = wob_input_init(&client->input, fd);
+		client->input.receive_fds = true;
+		if (!initialized || !wob_event_loop_add(&app->event_loop, &client->source, EPOLLIN)) {
+			close(fd);
+			free(client);
+			continue;
+		}
+
+		wl_list_insert(app->clients.prev, &client->link);
+		wob_log_debug("Client %d connected", fd);
+	}
+}
+
+bool
+wob_listener_add(struct wob *app, int fd, const char *path)
+{
+	struct wob_listener *listener = calloc(1, sizeof(struct wob_listener));
+	if (listener == NULL) {
+		wob_log_error("calloc failed");
+		close(fd);
+		return false;
+	}
+
+	listener->app = app;
+	listener->path = path;
+	listener->source = (struct wob_event_source){
+		.fd = fd,
+		.handle = wob_handle_listener,
+	};
+	wl_list_insert(app->listeners.prev, &listener->link);
+
+	return wob_event_loop_add(&app->event_loop, &listener->source, EPOLLIN);
+}
+
+// opened again on every read, unlike the value file nothing tells when the maximum file is replaced
+bool
+wob_source_read_max(struct wob_source *source, long long *max)
+{
+	int fd = open(source->max_path, O_RDONLY | O_CLOEXEC);
+	if (fd == -1) {
+		wob_log_warn("Cannot open %s: %s", source->max_path, strerror(errno));
+		return false;
+	}
+
+	bool valid = wob_source_read(fd, max);
+	close(fd);
+
+	return valid;
+}
+
+// value of the file mapped onto the channel, the expression works on the raw numbers read
+bool
+wob_source_scale(struct wob_source *source, long long *scaled)
+{
+	long long value;
+	long long max = source->max;
+	if (!wob_source_read(source->source.fd, &value) || (source->max_path != NULL && !wob_source_read_max(source, &max))) {
+		return false;
+	}
+
+	if (source->expression != NULL) {
+		if (!wob_source_eval(source->expression, value, max, scaled)) {
+			return false;
+		}
+	}
+	else if (max <= 0 || __builtin_mul_overflow(value, (long long) source->channel->maximum, scaled)) {
+		return false;
+	}
+	else {
+		*scaled /= max;
+	}
+
+	*scaled = MAX(*scaled, 0);
+
+	return true;
+}
+
+// files are often rewritten with the value they already hold, only changes show the bar
+void
+wob_source_update(struct wob_source *source)
+{
+	struct wob *app = source->app;
+
+	long long scaled;
+	if (!wob_source_scale(source, &scaled)) {
+		// a file being rewritten can be empty for a moment, the next change brings a complete value
+		wob_log_warn("Skipping invalid value of %s", source->path);
+		return;
+	}
+
+	if (scaled == source->last) {
+		return;
+	}
+	source->last = scaled;
+
+	if (!wob_receive(source->channel, WOB_COMMAND_SET, scaled) || !wob_apply_received(app)) {
+		wob_quit(app, EXIT_FAILURE);
+	}
+}
+
+void
+wob_handle_source(struct wob_event_source *event_source, uint32_t events)
+{
+	struct wob_source *source = wl_container_of(event_source, source, source);
+
+	// sysfs reports EPOLLERR along with EPOLLPRI, reading the attribute again acknowledges both
+	wob_source_update(source);
+}
+
+void
+wob_handle_source_timer(struct wob_event_source *event_source, uint32_t events)
+{
+	struct wob_source *source = wl_container_of(event_source, source, timer_source);
+
+	uint64_t expirations;
+	if (read(event_source->fd, &expirations, sizeof(expirations)) != sizeof(expirations) && errno != EAGAIN) {
+		wob_log_error("read() from timerfd failed: %s", strerror(errno));
+		wob_quit(source->app, EXIT_FAILURE);
+		return;
+	}
+
+	wob_source_update(source);
+}
+
+// editors and daemons often write a new file and rename it over the old one, the descriptor and the watch follow
+void
+wob_source_reopen(struct wob_source *source)
+{
+	struct wob *app = source->app;
+
+	int fd = open(source->path, O_RDONLY | O_CLOEXEC);
+	if (fd == -1) {
+		wob_log_warn("Cannot open %s again: %s", source->path, strerror(errno));
+		return;
+	}
+	close(source->source.fd);
+	source->source.fd = fd;
+
+	int watch = inotify_add_watch(app->inotify_source.fd, source->path, IN_MODIFY | IN_CLOSE_WRITE);
+	if (watch == -1) {
+		wob_log_warn("inotify_add_watch() failed: %s", strerror(errno));
+	}
+
+	// watch of the old inode may still be shared by another source of the same file
+	bool shared = false;
+	struct wob_source *other;
+	wl_list_for_each (other, &app->sources, link) {
+		shared = shared || (other != source && other->watch == source->watch);
+	}
+	if (source->watch != -1 && source->watch != watch && !shared) {
+		inotify_rm_watch(app->inotify_source.fd, source->watch);
+	}
+	source->watch = watch;
+
+	wob_log_debug("%s was replaced, reading the new file", source->path);
+	wob_source_update(source);
+}
+
+void
+wob_handle_inotify(struct wob_event_source *event_source, uint32_t events)
+{
+	struct wob *app = wl_container_of(event_source, app, inotify_source);
+
+	char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+	ssize_t length;
+	while ((length = read(event_source->fd, buffer, sizeof(buffer))) > 0) {
+		for (char *position = buffer; position < buffer + length;) {
+			const struct inotify_event *event = (const struct inotify_event *) position;
+			position += sizeof(struct inotify_event) + event->len;
+
+			struct wob_source *source;
+			wl_list_for_each (source, &app->sources, link) {
+				if (source->watch == event->wd) {
+					wob_source_update(source);
+				}
+				else if (source->directory_watch == event->wd && event->len > 0 && strcmp(event->name, source->name) == 0) {
+					wob_source_reopen(source);
+				}
+			}
+		}
+	}
+
+	if (length == -1 && errno != EAGAIN) {
+		wob_log_error("read() from inotify failed: %s", strerror(errno));
+		wob_quit(app, EXIT_FAILURE);
+	}
+}
+
+// sysfs attributes never generate inotify events, drivers wake up pollers of the attribute instead
+bool
+wob_source_watch(struct wob *app, struct wob_source *source)
+{
+	source->source = (struct wob_event_source){
+		.fd = open(source->path, O_RDONLY | O_CLOEXEC),
+		.handle = wob_handle_source,
+	};
+	if (source->source.fd == -1) {
+		wob_log_error("Cannot open %s: %s", source->path, strerror(errno));
+		return false;
+	}
+
+	// current value is only remembered, the bar shows up once it changes
+	if (!wob_source_scale(source, &source->last)) {
+		wob_log_error("Cannot read a valid value from %s", source->path);
+		return false;
+	}
+
+	struct statfs filesystem;
+	if (fstatfs(source->source.fd, &filesystem) == -1) {
+		wob_log_error("fstatfs() failed: %s", strerror(errno));
+		return false;
+	}
+
+	if (filesystem.f_type == SYSFS_MAGIC) {
+		if (!wob_event_loop_add(&app->event_loop, &source->source, EPOLLPRI)) {
+			return false;
+		}
+	}
+	else {
+		if (app->inotify_source.fd == -1) {
+			app->inotify_source.fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+			if (app->inotify_source.fd == -1 || !wob_event_loop_add(&app->event_loop, &app->inotify_source, EPOLLIN)) {
+				wob_log_error("inotify_init1() failed: %s", strerror(errno));
+				return false;
+			}
+		}
+
+		source->watch = inotify_add_watch(app->inotify_source.fd, source->path, IN_MODIFY | IN_CLOSE_WRITE);
+		if (source->watch == -1) {
+			wob_log_error("inotify_add_watch() failed: %s", strerror(errno));
+			return false;
+		}
+
+		// the root directory keeps its slash
+		const char *separator = strrchr(source->path, '/');
+		source->name = separator != NULL ? separator + 1 : source->path;
+		char *directory = separator != NULL ? strndup(source->path, MAX(separator - source->path, 1)) : strdup(".");
+		if (directory == NULL) {
+			wob_log_error("strdup failed");
+			return false;
+		}
+		source->directory_watch = inotify_add_watch(app->inotify_source.fd, directory, IN_CREATE | IN_MOVED_TO);
+		free(directory);
+		if (source->directory_watch == -1) {
+			wob_log_error("inotify_add_watch() failed: %s", strerror(errno));
+			return false;
+		}
+	}
+
+	if (source->interval_msec > 0) {
+		source->timer_source = (struct wob_event_source){
+			.fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK),
+			.handle = wob_handle_source_timer,
+		};
+		struct timespec interval = {
+			.tv_sec = source->interval_msec / 1000,
+			.tv_nsec = (source->interval_msec % 1000) * 1000000L,
+		};
+		struct itimerspec timer_value = {.it_interval = interval, .it_value = interval};
+		if (source->timer_source.fd == -1 || timerfd_settime(source->timer_source.fd, 0, &timer_value, NULL) == -1) {
+			wob_log_error("timerfd failed: %s", strerror(errno));
+			return false;
+		}
+
+		if (!wob_event_loop_add(&app->event_loop, &source->timer_source, EPOLLIN)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void
+wob_handle_timer(struct wob_event_source *source, uint32_t events)
+{
+	struct wob *app = wl_container_of(source, app, timer_source);
+
+	uint64_t expirations;
+	if (read(source->fd, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+		// timer was re-armed by input in the meantime
+		if (errno == EAGAIN) {
+			return;
+		}
+
+		wob_log_error("read() from timerfd failed: %s", strerror(errno));
+		wob_quit(app, EXIT_FAILURE);
+		return;
+	}
+
+	struct timespec now;
+	if (clock_gettime(CLOCK_MONOTONIC, &now) != 0) {
+		wob_log_error("clock_gettime() failed: %s", strerror(errno));
+		wob_quit(app, EXIT_FAILURE);
+		return;
+	}
+
+	struct wob_channel *channel;
+	wl_list_for_each (channel, &app->channels, link) {
+		const struct timespec *deadline = &channel->hide_deadline;
+		if (deadline->tv_sec < now.tv_sec || (deadline->tv_sec == now.tv_sec && deadline->tv_nsec <= now.tv_nsec)) {
+			wob_hide_now(channel);
+		}
+	}
+
+	if (!wob_timer_arm(app)) {
+		wob_quit(app, EXIT_FAILURE);
+	}
+}
+
+void
+wob_handle_signal(struct wob_event_source *source, uint32_t events)
+{
+	struct wob *app = wl_container_of(source, app, signal_source);
+
+	struct wob_channel *channel;
+	struct signalfd_siginfo siginfo;
+	if (read(source->fd, &siginfo, sizeof(siginfo)) != sizeof(siginfo)) {
+		wob_log_error("read() from signalfd failed: %s", strerror(errno));
+		wob_quit(app, EXIT_FAILURE);
+		return;
+	}
+
+	switch (siginfo.ssi_signo) {
+		case SIGUSR1:
+			wob_log_info("Received SIGUSR1, hiding bar");
+			wl_list_for_each (channel, &app->channels, link) {
+				wob_hide_now(channel);
+			}
+			if (!wob_timer_arm(app)) {
+				wob_quit(app, EXIT_FAILURE);
+			}
+			break;
+		default:
+			wob_log_info("Received signal %u, exiting", siginfo.ssi_signo);
+			wob_quit(app, EXIT_SUCCESS);
+			break;
+	}
+}
+
+bool
+wob_event_loop_setup(struct wob *app)
+{
+	if (!wob_event_loop_init(&app->event_loop)) {
+		return false;
+	}
+
+	app->timer_source = (struct wob_event_source){
+		.fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK),
+		.handle = wob_handle_timer,
+	};
+	if (app->timer_source.fd == -1) {
+		wob_log_error("timerfd_create() failed: %s", strerror(errno));
+		return false;
+	}
+
+	// signals are only ever delivered through signalfd, so that they are handled in between other events
+	sigset_t mask;
+	sigemptyset(&mask);
+	sigaddset(&mask, SIGINT);
+	sigaddset(&mask, SIGTERM);
+	sigaddset(&mask, SIGHUP);
+	sigaddset(&mask, SIGUSR1);
+	if (sigprocmask(SIG_BLOCK, &mask, NULL) == -1) {
+		wob_log_error("sigprocmask() failed: %s", strerror(errno));
+		return false;
+	}
+
+	app->signal_source = (struct wob_event_source){
+		.fd = signalfd(-1, &mask, SFD_CLOEXEC | SFD_NONBLOCK),
+		.handle = wob_handle_signal,
+	};
+	if (app->signal_source.fd == -1) {
+		wob_log_error("signalfd() failed: %s", strerror(errno));
+		return false;
+	}
+
+	app->display_source = (struct wob_event_source){
+		.fd = wl_display_get_fd(app->wl_display),
+		.handle = wob_handle_display,
+	};
+	app->display_events = EPOLLIN;
+
+	if (!wob_event_loop_add(&app->event_loop, &app->display_source, app->display_events)) {
+		return false;
+	}
+
+	if (!wob_event_loop_add(&app->event_loop, &app->timer_source, EPOLLIN)) {
+		return false;
+	}
+
+	if (!wob_event_loop_add(&app->event_loop, &app->signal_source, EPOLLIN)) {
+		return false;
+	}
+
+	int listen_fds = wob_server_listen_fds();
+	for (int fd = WOB_SERVER_LISTEN_FDS_START; fd < WOB_SERVER_LISTEN_FDS_START + listen_fds; ++fd) {
+		if (wob_server_adopt(fd) && !wob_listener_add(app, fd, NULL)) {
+			return false;
+		}
+	}
+
+	if (app->socket_path != NULL) {
+		int fd = wob_server_listen(app->socket_path);
+		if (fd == -1 || !wob_listener_add(app, fd, app->socket_path)) {
+			return false;
+		}
+	}
+
+	struct wob_source *source;
+	wl_list_for_each (source, &app->sources, link) {
+		if (!wob_source_watch(app, source)) {
+			return false;
+		}
+	}
+
+	// as a server or with watched files, wob keeps running when clients disconnect and STDIN is usually /dev/null
+	if (!wl_list_empty(&app->listeners) || !wl_list_empty(&app->sources)) {
+		return true;
+	}
+
+	app->stdin_source = (struct wob_event_source){
+		.fd = STDIN_FILENO,
+		.handle = wob_handle_stdin,
+	};
+	if (!wob_input_init(&app->stdin_input, STDIN_FILENO)) {
+		return false;
+	}
+
+	if (app->threaded_input) {
+		return wob_input_thread_start(app);
+	}
+
+	if (!wob_event_loop_add(&app->event_loop, &app->stdin_source, EPOLLIN)) {
+		if (errno == EPERM) {
+			wob_log_error("STDIN must be a pipe, FIFO, socket or terminal");
+		}
+		return false;
+	}
+
+	return true;
+}
+
+bool
+wob_parse_anchor(const char *str, unsigned long *anchor)
+{
+	if (strcmp(str, "left") == 0) {
+		*anchor |= ZWLR_LAYER_SURFACE_V1_ANCHOR_LEFT;
+	}
+	else if (strcmp(str, "right") == 0) {
+		*anchor |= ZWLR_LAYER_SURFACE_V1_ANCHOR_RIGHT;
+	}
+	else if (strcmp(str, "top") == 0) {
+		*anchor |= ZWLR_LAYER_SURFACE_V1_ANCHOR_TOP;
+	}
+	else if (strcmp(str, "bottom") == 0) {
+		*anchor |= ZWLR_LAYER_SURFACE_V1_ANCHOR_BOTTOM;
+	}
+	else if (strcmp(str, "center") != 0) {
+		return false;
 	}
 
-	if (wl_display_dispatch(app->wl_display) == -1) {
-		wob_log_error("wl_display_dispatch failed");
-		exit(EXIT_FAILURE);
-	}
+	return true;
 }
 
-void
-wob_hide(struct wob *app)
+bool
+wob_parse_ulong(const char *str, unsigned long *result)
 {
-	if (wl_list_empty(&(app->wob_outputs))) {
-		wob_log_info("Hiding bar on focused output");
-		wob_surface_destroy(app->fallback_wob_surface);
-		free(app->fallback_wob_surface);
-		app->fallback_wob_surface = NULL;
-	}
-	else {
-		struct wob_output *output, *tmp;
-		wl_list_for_each_safe (output, tmp, &app->wob_outputs, link) {
-			wob_log_info("Hiding bar on output %s", output->name);
-			wob_surface_destroy(output->wob_surface);
-			free(output->wob_surface);
-			output->wob_surface = NULL;
-		}
+	char *end;
+	errno = 0;
+	unsigned long value = strtoul(str, &end, 10);
+	if (end == str || *end != '\0' || errno == ERANGE) {
+		return false;
 	}
 
-	if (wl_display_roundtrip(app->wl_display) == -1) {
-		wob_log_error("wl_display_roundtrip failed");
-		exit(EXIT_FAILURE);
-	}
+	*result = value;
+	return true;
 }
 
-void
-wob_show(struct wob *app)
+bool
+wob_parse_overflow_mode(const char *str, enum wob_overflow_mode *overflow_mode)
 {
-	if (wl_list_empty(&(app->wob_outputs))) {
-		wob_log_info("No output matching configuration found, fallbacking to focused output");
-		app->fallback_wob_surface = wob_surface_create(app, NULL);
+	if (strcmp(str, "none") == 0) {
+		*overflow_mode = OVERFLOW_MODE_NONE;
+	}
+	else if (strcmp(str, "wrap") == 0) {
+		*overflow_mode = OVERFLOW_MODE_WRAP;
+	}
+	else if (strcmp(str, "nowrap") == 0) {
+		*overflow_mode = OVERFLOW_MODE_NOWRAP;
 	}
 	else {
-		struct wob_output *output, *tmp;
-		wl_list_for_each_safe (output, tmp, &app->wob_outputs, link) {
-			wob_log_info("Showing bar on output %s", output->name);
-			output->wob_surface = wob_surface_create(app, output->wl_output);
-		}
+		return false;
 	}
 
-	if (wl_display_roundtrip(app->wl_display) == -1) {
-		wob_log_error("wl_display_roundtrip failed");
-		exit(EXIT_FAILURE);
-	}
+	return true;
 }
 
-void
-wob_destroy(struct wob *app)
+// size in pixels, or in percent of the logical size of the output when followed by '%'
+bool
+wob_parse_size(const char *str, unsigned long *pixels, unsigned long *percent)
 {
-	struct wob_output *output, *output_tmp;
-	wl_list_for_each_safe (output, output_tmp, &app->wob_outputs, link) {
-		wob_output_destroy(output);
-		free(output);
+	char *end;
+	errno = 0;
+	unsigned long value = strtoul(str, &end, 10);
+	if (end == str || errno == ERANGE) {
+		return false;
 	}
 
-	struct wob_output_config *config, *config_tmp;
-	wl_list_for_each_safe (config, config_tmp, &app->output_configs, link) {
-		free(config->name);
-		free(config);
+	if (end[0] == '%' && end[1] == '\0') {
+		*percent = value;
+		return value > 0 && value <= 100;
 	}
 
-	zwlr_layer_shell_v1_destroy(app->wlr_layer_shell);
-	wl_registry_destroy(app->wl_registry);
-	wl_buffer_destroy(app->wl_buffer);
-	wl_compositor_destroy(app->wl_compositor);
-	wl_shm_destroy(app->wl_shm);
-	zxdg_output_manager_v1_destroy(app->xdg_output_manager);
+	if (*end != '\0') {
+		return false;
+	}
 
-	wl_display_disconnect(app->wl_display);
+	*pixels = value;
+	*percent = 0;
+	return true;
 }
 
-void
-wob_connect(struct wob *app)
+bool
+wob_parse_profile_color(const char *str, struct wob_color *color, unsigned int *colors_set, unsigned int color_flag)
 {
-	const static struct wl_registry_listener wl_registry_listener = {
-		.global = handle_global,
-		.global_remove = noop,
-	};
-
-	app->wl_display = wl_display_connect(NULL);
-	if (app->wl_display == NULL) {
-		wob_log_error("wl_display_connect failed");
-		exit(EXIT_FAILURE);
+	char *end;
+	if (!wob_parse_color(str, &end, color) || *end != '\0') {
+		return false;
 	}
 
-	app->wl_registry = wl_display_get_registry(app->wl_display);
-	if (app->wl_registry == NULL) {
-		wob_log_error("wl_display_get_registry failed");
-		exit(EXIT_FAILURE);
+	*colors_set |= color_flag;
+	return true;
+}
+
+// geometry and color settings shared by --output and --channel, returns false when the key is none of them
+bool
+wob_profile_set(struct wob_profile *profile, const char *key, const char *value, bool *valid)
+{
+	if (strcmp(key, "width") == 0) {
+		*valid = wob_parse_size(value, &profile->geom.width, &profile->width_percent);
+		profile->geom_set |= WOB_PROFILE_WIDTH;
+	}
+	else if (strcmp(key, "height") == 0) {
+		*valid = wob_parse_size(value, &profile->geom.height, &profile->height_percent);
+		profile->geom_set |= WOB_PROFILE_HEIGHT;
+	}
+	else if (strcmp(key, "offset") == 0) {
+		*valid = wob_parse_ulong(value, &profile->geom.border_offset);
+		profile->geom_set |= WOB_PROFILE_BORDER_OFFSET;
+	}
+	else if (strcmp(key, "border") == 0) {
+		*valid = wob_parse_ulong(value, &profile->geom.border_size);
+		profile->geom_set |= WOB_PROFILE_BORDER_SIZE;
+	}
+	else if (strcmp(key, "padding") == 0) {
+		*valid = wob_parse_ulong(value, &profile->geom.bar_padding);
+		profile->geom_set |= WOB_PROFILE_BAR_PADDING;
+	}
+	else if (strcmp(key, "margin") == 0) {
+		*valid = wob_parse_ulong(value, &profile->geom.margin);
+		profile->geom_set |= WOB_PROFILE_MARGIN;
+	}
+	else if (strcmp(key, "anchor") == 0) {
+		// anchors of the profile replace those from the command line
+		if (!(profile->geom_set & WOB_PROFILE_ANCHOR)) {
+			profile->geom.anchor = 0;
+			profile->geom_set |= WOB_PROFILE_ANCHOR;
+		}
+		*valid = wob_parse_anchor(value, &profile->geom.anchor);
+	}
+	else if (strcmp(key, "bar-color") == 0) {
+		*valid = wob_parse_profile_color(value, &profile->colors.bar, &profile->colors_set, WOB_PROFILE_BAR_COLOR);
+	}
+	else if (strcmp(key, "background-color") == 0) {
+		*valid = wob_parse_profile_color(value, &profile->colors.background, &profile->colors_set, WOB_PROFILE_BACKGROUND_COLOR);
+	}
+	else if (strcmp(key, "border-color") == 0) {
+		*valid = wob_parse_profile_color(value, &profile->colors.border, &profile->colors_set, WOB_PROFILE_BORDER_COLOR);
+	}
+	else if (strcmp(key, "overflow-bar-color") == 0) {
+		*valid = wob_parse_profile_color(value, &profile->overflow_colors.bar, &profile->overflow_colors_set, WOB_PROFILE_BAR_COLOR);
+	}
+	else if (strcmp(key, "overflow-background-color") == 0) {
+		*valid = wob_parse_profile_color(value, &profile->overflow_colors.background, &profile->overflow_colors_set, WOB_PROFILE_BACKGROUND_COLOR);
+	}
+	else if (strcmp(key, "overflow-border-color") == 0) {
+		*valid = wob_parse_profile_color(value, &profile->overflow_colors.border, &profile->overflow_colors_set, WOB_PROFILE_BORDER_COLOR);
+	}
+	else {
+		return false;
 	}
 
-	wl_registry_add_listener(app->wl_registry, &wl_registry_listener, app);
+	return true;
+}
 
-	wl_list_init(&app->wob_outputs);
-	if (wl_display_roundtrip(app->wl_display) == -1) {
-		wob_log_error("wl_display_roundtrip failed");
-		exit(EXIT_FAILURE);
+// splits the next <key>=<value> pair off comma separated settings
+bool
+wob_settings_next(char **settings, char **key, char **value)
+{
+	while (*settings != NULL && **settings == ',') {
+		*settings += 1;
 	}
 
-	struct wl_shm_pool *pool = wl_shm_create_pool(app->wl_shm, app->shmid, app->wob_geom->size);
-	if (pool == NULL) {
-		wob_log_error("wl_shm_create_pool failed");
-		exit(EXIT_FAILURE);
+	if (*settings == NULL || **settings == '\0') {
+		return false;
 	}
 
-	app->wl_buffer = wl_shm_pool_create_buffer(pool, 0, app->wob_geom->width, app->wob_geom->height, app->wob_geom->stride, WL_SHM_FORMAT_ARGB8888);
-	wl_shm_pool_destroy(pool);
-	if (app->wl_buffer == NULL) {
-		wob_log_error("wl_shm_pool_create_buffer failed");
-		exit(EXIT_FAILURE);
+	*key = *settings;
+	*settings = strchr(*key, ',');
+	if (*settings != NULL) {
+		*(*settings)++ = '\0';
+	}
+
+	*value = strchr(*key, '=');
+	if (*value != NULL) {
+		*(*value)++ = '\0';
 	}
+
+	return true;
 }
 
-void
-wob_draw_background(const struct wob_geom *geom, uint32_t *argb, struct wob_color color)
+// settings of --output <name>:<key>=<value>,... take precedence over those of the channel on matching outputs
+bool
+wob_output_config_parse(struct wob_output_config *config)
 {
-	uint32_t argb_color = wob_color_to_argb(wob_color_premultiply_alpha(color));
+	char *settings = config->settings;
+	char *key, *value;
+	while (wob_settings_next(&settings, &key, &value)) {
+		bool valid = false;
+		if (value != NULL && !wob_profile_set(&config->profile, key, value, &valid)) {
+			wob_log_error("Unknown setting %s of output %s.", key, config->name);
+			return false;
+		}
 
-	for (size_t i = 0; i < geom->width * geom->height; ++i) {
-		argb[i] = argb_color;
+		if (!valid) {
+			wob_log_error("Invalid value of setting %s of output %s.", key, config->name);
+			return false;
+		}
 	}
+
+	return true;
 }
 
-void
-wob_draw_border(const struct wob_geom *geom, uint32_t *argb, struct wob_color color)
+// settings of --channel <name>:<key>=<value>,... are applied on top of the command line options
+bool
+wob_channel_parse(struct wob_channel *channel)
 {
-	uint32_t argb_color = wob_color_to_argb(wob_color_premultiply_alpha(color));
-
-	// create top and bottom line
-	size_t i = geom->width * geom->border_offset;
-	size_t k = geom->width * (geom->height - geom->border_offset - geom->border_size);
-	for (size_t line = 0; line < geom->border_size; ++line) {
-		i += geom->border_offset;
-		k += geom->border_offset;
-		for (size_t pixel = 0; pixel < geom->width - 2 * geom->border_offset; ++pixel) {
-			argb[i++] = argb_color;
-			argb[k++] = argb_color;
+	struct wob_profile profile = {0};
+
+	char *settings = channel->settings;
+	char *key, *value;
+	while (wob_settings_next(&settings, &key, &value)) {
+		bool valid = false;
+		if (value == NULL) {
+			valid = false;
+		}
+		else if (wob_profile_set(&profile, key, value, &valid)) {
+			valid = valid && profile.width_percent == 0 && profile.height_percent == 0;
+		}
+		else if (strcmp(key, "max") == 0) {
+			valid = wob_parse_ulong(value, &channel->maximum) && channel->maximum > 0;
+		}
+		else if (strcmp(key, "timeout") == 0) {
+			valid = wob_parse_ulong(value, &channel->timeout_msec) && channel->timeout_msec > 0;
+		}
+		else if (strcmp(key, "overflow-mode") == 0) {
+			valid = wob_parse_overflow_mode(value, &channel->overflow_mode);
+		}
+		else if (strcmp(key, "animation-duration") == 0) {
+			valid = wob_parse_ulong(value, &channel->animation.duration_msec);
+		}
+		else if (strcmp(key, "animation-easing") == 0) {
+			valid = wob_parse_easing(value, &channel->animation.easing);
+		}
+		else {
+			wob_log_error("Unknown setting %s of channel %s.", key, channel->name);
+			return false;
 		}
-		i += geom->border_offset;
-		k += geom->border_offset;
-	}
 
-	// create left and right horizontal line
-	i = geom->width * (geom->border_offset + geom->border_size);
-	k = geom->width * (geom->border_offset + geom->border_size);
-	for (size_t line = 0; line < geom->height - 2 * (geom->border_size + geom->border_offset); ++line) {
-		i += geom->border_offset;
-		k += geom->width - geom->border_offset - geom->border_size;
-		for (size_t pixel = 0; pixel < geom->border_size; ++pixel) {
-			argb[i++] = argb_color;
-			argb[k++] = argb_color;
+		if (!valid) {
+			wob_log_error("Invalid value of setting %s of channel %s.", key, channel->name);
+			return false;
 		}
-		i += geom->width - geom->border_offset - geom->border_size;
-		k += geom->border_offset;
 	}
+
+	// colors of the channel can still be changed by input, unlike those of output profiles
+	wob_profile_geom(&profile, NULL, &channel->geom);
+	wob_profile_colors_apply(&channel->colors, &profile.colors, profile.colors_set);
+	wob_profile_colors_apply(&channel->overflow_colors, &profile.overflow_colors, profile.overflow_colors_set);
+
+	return true;
 }
 
-void
-wob_draw_percentage(const struct wob_geom *geom, uint32_t *argb, struct wob_color bar_color, struct wob_color background_color, unsigned long percentage, unsigned long maximum)
+// settings of --watch <path>:<key>=<value>,... need the channels to be set up
+bool
+wob_source_parse(struct wob *app, struct wob_source *source)
 {
-	uint32_t argb_bar_color = wob_color_to_argb(wob_color_premultiply_alpha(bar_color));
-	uint32_t argb_background_color = wob_color_to_argb(wob_color_premultiply_alpha(background_color));
+	const char *channel_name = NULL;
+	source->channel = wl_container_of(app->channels.next, source->channel, link);
+
+	char *settings = source->settings;
+	char *key, *value;
+	while (wob_settings_next(&settings, &key, &value)) {
+		bool valid = true;
+		if (value == NULL || value[0] == '\0') {
+			valid = false;
+		}
+		else if (strcmp(key, "max") == 0) {
+			unsigned long max;
+			if (wob_parse_ulong(value, &max)) {
+				valid = max > 0 && max <= LLONG_MAX;
+				source->max = max;
+			}
+			else {
+				source->max_path = value;
+			}
+		}
+		else if (strcmp(key, "scale") == 0) {
+			source->expression = value;
+		}
+		else if (strcmp(key, "channel") == 0) {
+			channel_name = value;
+		}
+		else if (strcmp(key, "interval") == 0) {
+			valid = wob_parse_ulong(value, &source->interval_msec) && source->interval_msec > 0;
+		}
+		else {
+			wob_log_error("Unknown setting %s of watched file %s.", key, source->path);
+			return false;
+		}
 
-	size_t offset_border_padding = geom->border_offset + geom->border_size + geom->bar_padding;
-	size_t bar_width = geom->width - 2 * offset_border_padding;
-	size_t bar_height = geom->height - 2 * offset_border_padding;
-	size_t bar_colored_width = (bar_width * percentage) / maximum;
+		if (!valid) {
+			wob_log_error("Invalid value of setting %s of watched file %s.", key, source->path);
+			return false;
+		}
+	}
 
-	// draw 1px horizontal line
-	uint32_t *start, *end, *pixel;
-	start = &argb[offset_border_padding * (geom->width + 1)];
-	end = start + bar_colored_width;
-	for (pixel = start; pixel < end; ++pixel) {
-		*pixel = argb_bar_color;
+	if (app->named_channels) {
+		struct wob_channel *channel = NULL;
+		wl_list_for_each (source->channel, &app->channels, link) {
+			if (channel_name != NULL && strcmp(source->channel->name, channel_name) == 0) {
+				channel = source->channel;
+				break;
+			}
+		}
+
+		if (channel == NULL) {
+			wob_log_error("Watched file %s needs the channel setting naming one of the channels.", source->path);
+			return false;
+		}
+		source->channel = channel;
 	}
-	for (end = start + bar_width; pixel < end; ++pixel) {
-		*pixel = argb_background_color;
+	else if (channel_name != NULL) {
+		wob_log_error("Watched file %s names a channel, but there are none.", source->path);
+		return false;
 	}
 
-	// copy it to make full percentage bar
-	uint32_t *source = &argb[offset_border_padding * geom->width];
-	uint32_t *destination = source + geom->width;
-	end = &argb[geom->width * (bar_height + offset_border_padding)];
-	while (destination != end) {
-		memcpy(destination, source, MIN(destination - source, end - destination) * sizeof(uint32_t));
-		destination += MIN(destination - source, end - destination);
+	if (source->max == 0 && source->max_path == NULL) {
+		source->max = source->channel->maximum;
 	}
-}
 
-static char stdin_buffer[STDIN_BUFFER_LENGTH];
+	return true;
+}
 
 int
 main(int argc, char **argv)
@@ -485,14 +3462,6 @@ main(int argc, char **argv)
 	wob_log_use_colors(isatty(STDERR_FILENO));
 	wob_log_level_warn();
 
-	// libc is doing fstat syscall to determine the optimal buffer size and that can be problematic to wob_pledge()
-	// to solve this problem we can just pass the optimal buffer ourselves
-	if (setvbuf(stdin, stdin_buffer, _IOFBF, sizeof(stdin_buffer)) != 0) {
-		wob_log_error("Failed to set stdin buffer size to %zu", sizeof(stdin_buffer));
-
-		return EXIT_FAILURE;
-	}
-
 	const char *usage =
 		"Usage: wob [options]\n"
 		"\n"
@@ -509,8 +3478,10 @@ main(int argc, char **argv)
 		"  -a, --anchor <s>                    Define anchor point; one of 'top', 'left', 'right', 'bottom', 'center' (default). \n"
 		"                                      May be specified multiple times. \n"
 		"  -M, --margin <px>                   Define anchor margin in pixels, defaults to " STR(WOB_DEFAULT_MARGIN) ". \n"
-		"  -O, --output <name>                 Define output to show bar on or '*' for all. If ommited, focused output is chosen.\n"
-		"                                      May be specified multiple times.\n"
+		"  -O, --output <name>[:<settings>]    Define output to show bar on or '*' for all. If ommited, focused output is chosen.\n"
+		"                                      May be specified multiple times. Settings are comma separated <key>=<value>\n"
+		"                                      pairs overriding the options of the same name for this output; width, height\n"
+		"                                      (px or % of the output), offset, border, padding, anchor, margin and colors.\n"
 		"  --border-color <#rgba>              Define border color\n"
 		"  --background-color <#rgba>          Define background color\n"
 		"  --bar-color <#rgba>                 Define bar color\n"
@@ -518,14 +3489,43 @@ main(int argc, char **argv)
 		"  --overflow-bar-color <#rgba>        Define bar color when overflowed\n"
 		"  --overflow-border-color <#rgba>     Define the border color when overflowed\n"
 		"  --overflow-background-color <#rgba> Define the background color when overflowed\n"
+		"  --persistent-surfaces               Keep layer surfaces alive while hidden, showing the bar then takes a single commit.\n"
+		"  --input-format <format>             Define format of the input; one of 'text' (default), 'binary'.\n"
+		"  --frame-atlas                       Pre-render every state of the bar, updates only attach a ready buffer.\n"
+		"  --strip-buffers                     Draw a single line of the bar and let the compositor scale it, needs wp_viewporter.\n"
+		"  --channel <name>[:<settings>]       Define a bar of its own, input lines then start with the channel name.\n"
+		"                                      May be specified multiple times. Settings are like those of --output, plus max,\n"
+		"                                      timeout, overflow-mode, animation-duration and animation-easing.\n"
+		"  --socket <path>                     Read input from clients of a UNIX socket listening at <path> instead of STDIN.\n"
+		"  --input-thread                      Read and parse STDIN on a thread of its own, by default everything runs on one thread.\n"
+		"  --render-threads <n>                Draw bars of several outputs on up to <n> extra threads, 0 draws everything on the\n"
+		"                                      main thread. Defaults to the number of CPUs less one, at most " STR(WOB_POOL_MAX_WORKERS) ".\n"
+		"  --animation-duration <ms>           Move the fill to new values over <ms> milliseconds, defaults to 0 (no animation).\n"
+		"  --animation-easing <curve>          Define the animation curve; one of 'linear', 'ease-in', 'ease-out' (default), 'ease-in-out'.\n"
+		"  --watch <path>[:<settings>]         Show the number in the file at <path> whenever it changes instead of reading STDIN.\n"
+		"                                      May be specified multiple times. Settings are max (number or path of a file),\n"
+		"                                      scale (expression of value and max), channel and interval (ms).\n"
 		"\n";
 
 	struct wob app = {0};
 	wl_list_init(&(app.output_configs));
+	wl_list_init(&(app.channels));
+	wl_list_init(&(app.listeners));
+	wl_list_init(&(app.clients));
+	wl_list_init(&(app.sources));
+	app.inotify_source = (struct wob_event_source){
+		.fd = -1,
+		.handle = wob_handle_inotify,
+	};
+	app.input_thread.source.fd = -1;
+	app.input_thread.wakeup_fd = -1;
 
 	unsigned long maximum = WOB_DEFAULT_MAXIMUM;
 	unsigned long timeout_msec = WOB_DEFAULT_TIMEOUT;
+	long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	unsigned long render_threads = cpus > 1 ? cpus - 1 : 0;
 	enum wob_overflow_mode overflow_mode = OVERFLOW_MODE_WRAP;
+	struct wob_animation animation = {.easing = WOB_EASING_EASE_OUT};
 	struct wob_geom geom = {
 		.width = WOB_DEFAULT_WIDTH,
 		.height = WOB_DEFAULT_HEIGHT,
@@ -537,14 +3537,14 @@ main(int argc, char **argv)
 	};
 
 	struct wob_colors colors = {
-		.background = (struct wob_color){.a = 1.0f, .r = 0.0f, .g = 0.0f, .b = 0.0f},
-		.bar = (struct wob_color){.a = 1.0f, .r = 1.0f, .g = 1.0f, .b = 1.0f},
-		.border = (struct wob_color){.a = 1.0f, .r = 1.0f, .g = 1.0f, .b = 1.0f}};
+		.background = (struct wob_color){.argb = 0xFF000000},
+		.bar = (struct wob_color){.argb = 0xFFFFFFFF},
+		.border = (struct wob_color){.argb = 0xFFFFFFFF}};
 
 	struct wob_colors overflow_colors = {
-		.background = (struct wob_color){.a = 1.0f, .r = 0.0f, .g = 0.0f, .b = 0.0f},
-		.bar = (struct wob_color){.a = 1.0f, .r = 1.0f, .g = 0.0f, .b = 0.0f},
-		.border = (struct wob_color){.a = 1.0f, .r = 1.0f, .g = 1.0f, .b = 1.0f}};
+		.background = (struct wob_color){.argb = 0xFF000000},
+		.bar = (struct wob_color){.argb = 0xFFFF0000},
+		.border = (struct wob_color){.argb = 0xFFFFFFFF}};
 
 	bool pledge = true;
 
@@ -554,6 +3554,8 @@ main(int argc, char **argv)
 	}
 
 	struct wob_output_config *output_config;
+	struct wob_channel *channel;
+	struct wob_source *source;
 	int option_index = 0;
 	int c;
 	char *strtoul_end;
@@ -577,7 +3579,18 @@ main(int argc, char **argv)
 		{"overflow-mode", required_argument, NULL, 6},
 		{"overflow-bar-color", required_argument, NULL, 5},
 		{"overflow-background-color", required_argument, NULL, 7},
-		{"overflow-border-color", required_argument, NULL, 8}};
+		{"overflow-border-color", required_argument, NULL, 8},
+		{"persistent-surfaces", no_argument, NULL, 9},
+		{"input-format", required_argument, NULL, 10},
+		{"frame-atlas", no_argument, NULL, 11},
+		{"strip-buffers", no_argument, NULL, 12},
+		{"channel", required_argument, NULL, 13},
+		{"socket", required_argument, NULL, 14},
+		{"input-thread", no_argument, NULL, 15},
+		{"render-threads", required_argument, NULL, 16},
+		{"watch", required_argument, NULL, 17},
+		{"animation-duration", required_argument, NULL, 18},
+		{"animation-easing", required_argument, NULL, 19}};
 
 	while ((c = getopt_long(argc, argv, "t:m:W:H:o:b:p:a:M:O:vh:f", long_options, &option_index)) != -1) {
 		switch (c) {
@@ -649,19 +3662,7 @@ main(int argc, char **argv)
 				}
 				break;
 			case 'a':
-				if (strcmp(optarg, "left") == 0) {
-					geom.anchor |= ZWLR_LAYER_SURFACE_V1_ANCHOR_LEFT;
-				}
-				else if (strcmp(optarg, "right") == 0) {
-					geom.anchor |= ZWLR_LAYER_SURFACE_V1_ANCHOR_RIGHT;
-				}
-				else if (strcmp(optarg, "top") == 0) {
-					geom.anchor |= ZWLR_LAYER_SURFACE_V1_ANCHOR_TOP;
-				}
-				else if (strcmp(optarg, "bottom") == 0) {
-					geom.anchor |= ZWLR_LAYER_SURFACE_V1_ANCHOR_BOTTOM;
-				}
-				else if (strcmp(optarg, "center") != 0) {
+				if (!wob_parse_anchor(optarg, &geom.anchor)) {
 					wob_log_error("Anchor must be one of 'top', 'bottom', 'left', 'right', 'center'.");
 					return EXIT_FAILURE;
 				}
@@ -687,6 +3688,12 @@ main(int argc, char **argv)
 					return EXIT_FAILURE;
 				}
 
+				// profile is parsed once all defaults are known
+				output_config->settings = strchr(output_config->name, ':');
+				if (output_config->settings != NULL) {
+					*output_config->settings++ = '\0';
+				}
+
 				wl_list_insert(&(app.output_configs), &(output_config->link));
 				break;
 			case 4:
@@ -705,16 +3712,7 @@ main(int argc, char **argv)
 				}
 				break;
 			case 6:
-				if (strcmp(optarg, "none") == 0) {
-					overflow_mode = OVERFLOW_MODE_NONE;
-				}
-				else if (strcmp(optarg, "wrap") == 0) {
-					overflow_mode = OVERFLOW_MODE_WRAP; // this is the default
-				}
-				else if (strcmp(optarg, "nowrap") == 0) {
-					overflow_mode = OVERFLOW_MODE_NOWRAP;
-				}
-				else {
+				if (!wob_parse_overflow_mode(optarg, &overflow_mode)) {
 					wob_log_error("Invalid argument for overflow-mode. Valid options are none, wrap, and nowrap.");
 					return EXIT_FAILURE;
 				}
@@ -731,6 +3729,111 @@ main(int argc, char **argv)
 					return EXIT_FAILURE;
 				}
 				break;
+			case 9:
+				app.persistent_surfaces = true;
+				break;
+			case 10:
+				if (strcmp(optarg, "text") == 0) {
+					app.input_format = INPUT_FORMAT_TEXT;
+				}
+				else if (strcmp(optarg, "binary") == 0) {
+					app.input_format = INPUT_FORMAT_BINARY;
+				}
+				else {
+					wob_log_error("Input format must be one of 'text', 'binary'.");
+					return EXIT_FAILURE;
+				}
+				break;
+			case 11:
+				app.frame_atlas = true;
+				break;
+			case 12:
+				app.strip_buffers = true;
+				break;
+			case 13:
+				channel = calloc(1, sizeof(struct wob_channel));
+				if (channel == NULL) {
+					wob_log_error("calloc failed");
+					return EXIT_FAILURE;
+				}
+
+				channel->name = strdup(optarg);
+				if (channel->name == NULL) {
+					free(channel);
+					wob_log_error("strdup failed");
+					return EXIT_FAILURE;
+				}
+
+				// settings are parsed once all defaults are known
+				channel->settings = strchr(channel->name, ':');
+				if (channel->settings != NULL) {
+					*channel->settings++ = '\0';
+				}
+
+				if (channel->name[0] == '\0' || strchr(channel->name, ' ') != NULL) {
+					wob_log_error("Channel name must be non-empty and without spaces.");
+					return EXIT_FAILURE;
+				}
+
+				wl_list_insert(app.channels.prev, &channel->link);
+				break;
+			case 14:
+				app.socket_path = optarg;
+				break;
+			case 15:
+				app.threaded_input = true;
+				break;
+			case 16:
+				render_threads = strtoul(optarg, &strtoul_end, 10);
+				if (*strtoul_end != '\0' || errno == ERANGE) {
+					wob_log_error("Render threads must be a number of threads, 0 to draw on the main thread only.");
+					return EXIT_FAILURE;
+				}
+				break;
+			case 17:
+				source = calloc(1, sizeof(struct wob_source));
+				if (source == NULL) {
+					wob_log_error("calloc failed");
+					return EXIT_FAILURE;
+				}
+
+				source->path = strdup(optarg);
+				if (source->path == NULL) {
+					free(source);
+					wob_log_error("strdup failed");
+					return EXIT_FAILURE;
+				}
+
+				// sysfs paths contain colons themselves, settings start at the first one followed by <key>=
+				for (char *separator = strchr(source->path, ':'); separator != NULL; separator = strchr(separator + 1, ':')) {
+					size_t key_length = strspn(separator + 1, "abcdefghijklmnopqrstuvwxyz");
+					if (key_length > 0 && separator[1 + key_length] == '=') {
+						*separator = '\0';
+						source->settings = separator + 1;
+						break;
+					}
+				}
+
+				source->app = &app;
+				source->watch = -1;
+				source->directory_watch = -1;
+				source->source.fd = -1;
+				source->timer_source.fd = -1;
+				wl_list_insert(app.sources.prev, &source->link);
+				break;
+			case 18:
+				animation.duration_msec = strtoul(optarg, &strtoul_end, 10);
+				if (*strtoul_end != '\0' || errno == ERANGE) {
+					wob_log_error("Animation duration must be a number of milliseconds, 0 disables animations.");
+					return EXIT_FAILURE;
+				}
+				break;
+			case 19:
+				if (!wob_parse_easing(optarg, &animation.easing)) {
+					wob_log_error("Invalid argument for animation-easing. Valid options are linear, ease-in, ease-out, and ease-in-out.");
+					return EXIT_FAILURE;
+				}
+				break;
 			default:
 				fprintf(stderr, "%s", usage);
 				return EXIT_FAILURE;
@@ -749,164 +3852,134 @@ main(int argc, char **argv)
 
 	geom.stride = geom.width * 4;
 	geom.size = geom.stride * geom.height;
-	app.wob_geom = &geom;
 
-	int shmid = wob_shm_create();
-	if (shmid < 0) {
-		return EXIT_FAILURE;
+	wl_list_for_each (output_config, &app.output_configs, link) {
+		if (!wob_output_config_parse(output_config)) {
+			return EXIT_FAILURE;
+		}
 	}
-	app.shmid = shmid;
 
-	uint32_t *argb = wob_shm_alloc(shmid, app.wob_geom->size);
-	if (argb == NULL) {
+	// without --channel there is a single bar configured by the command line alone
+	app.named_channels = !wl_list_empty(&app.channels);
+	if (!app.named_channels) {
+		channel = calloc(1, sizeof(struct wob_channel));
+		if (channel == NULL) {
+			wob_log_error("calloc failed");
+			return EXIT_FAILURE;
+		}
+		wl_list_insert(&app.channels, &channel->link);
+	}
+	else if (app.input_format != INPUT_FORMAT_TEXT) {
+		wob_log_error("Channels need the text input format.");
 		return EXIT_FAILURE;
 	}
 
+	wl_list_for_each (channel, &app.channels, link) {
+		channel->app = &app;
+		channel->geom = geom;
+		channel->maximum = maximum;
+		channel->timeout_msec = timeout_msec;
+		channel->overflow_mode = overflow_mode;
+		channel->animation = animation;
+		channel->colors = colors;
+		channel->overflow_colors = overflow_colors;
+		if (!wob_channel_parse(channel)) {
+			return EXIT_FAILURE;
+		}
+		channel->effective_colors = channel->colors;
+		channel->hidden = true;
+		wl_list_init(&channel->surfaces);
+	}
+
+	wl_list_for_each (source, &app.sources, link) {
+		if (!wob_source_parse(&app, source)) {
+			return EXIT_FAILURE;
+		}
+	}
+
 	wob_connect(&app);
 	if (app.wl_shm == NULL || app.wl_compositor == NULL || app.wlr_layer_shell == NULL) {
 		wob_log_error("Wayland compositor doesn't support all required protocols");
 		return EXIT_FAILURE;
 	}
 
+	// workers are only spawned once there is more than one large buffer to draw
+	if (!wob_pool_init(&app.render_pool, render_threads)) {
+		return EXIT_FAILURE;
+	}
+
+	if (!wob_event_loop_setup(&app)) {
+		return EXIT_FAILURE;
+	}
+
 	if (pledge) {
-		if (!wob_pledge()) {
+		if (!wob_pledge(!wl_list_empty(&app.sources), app.socket_path != NULL)) {
 			return EXIT_FAILURE;
 		}
 	}
 
-	struct wob_colors old_colors;
-	struct wob_colors effective_colors = colors;
+	if (app.persistent_surfaces) {
+		// surfaces are created once and from now on only mapped and unmapped
+		wl_list_for_each (channel, &app.channels, link) {
+			wob_show(channel);
+		}
+	}
 
-	// Draw these at least once
-	wob_draw_background(app.wob_geom, argb, colors.background);
-	wob_draw_border(app.wob_geom, argb, colors.border);
+	app.running = true;
+	app.exit_status = EXIT_SUCCESS;
+	while (app.running) {
+		if (wl_display_dispatch_pending(app.wl_display) == -1) {
+			wob_log_error("wl_display_dispatch_pending failed");
+			return EXIT_FAILURE;
+		}
 
-	struct pollfd fds[2] = {
-		{
-			.fd = wl_display_get_fd(app.wl_display),
-			.events = POLLIN,
-		},
-		{
-			.fd = STDIN_FILENO,
-			.events = POLLIN,
-		},
-	};
+		wob_render(&app);
 
-	bool hidden = true;
-	for (;;) {
-		unsigned long percentage = 0;
-		char input_buffer[INPUT_BUFFER_LENGTH] = {0};
-		char *fgets_rv;
+		// memory of the buffers is given back while hidden or unused by any surface, buffers still shown are released once compositor lets go of them
+		struct wob_renderer *renderer, *renderer_tmp;
+		wl_list_for_each_safe (renderer, renderer_tmp, &app.renderers, link) {
+			if (!wob_renderer_shown(&app, renderer) && !renderer->buffers_released) {
+				bool frames_released = wob_buffer_pool_release(&renderer->frame_pool);
+				bool atlas_released = !renderer->frame_atlas || wob_atlas_release(&renderer->atlas);
+				renderer->buffers_released = wob_buffer_pool_release(&renderer->buffer_pool) && frames_released && atlas_released;
+			}
 
-		switch (poll(fds, 2, hidden ? -1 : timeout_msec)) {
-			case -1:
-				wob_log_error("poll() failed: %s", strerror(errno));
+			// left behind by a change of scale or geometry, nothing is going to draw with it again
+			if (renderer->references == 0 && renderer->buffers_released) {
+				wob_renderer_destroy(&app, renderer);
+			}
+		}
 
+		// never block on the compositor, what does not fit into the socket is flushed once it becomes writable
+		uint32_t display_events = EPOLLIN;
+		if (wl_display_flush(app.wl_display) == -1) {
+			if (errno != EAGAIN) {
+				wob_log_error("wl_display_flush failed: %s", strerror(errno));
 				return EXIT_FAILURE;
-			case 0:
-				if (!hidden) wob_hide(&app);
-
-				hidden = true;
-				break;
-			default:
-				if (fds[0].revents) {
-					if (!(fds[0].revents & POLLIN)) {
-						wob_log_error("WL_DISPLAY_FD unexpectedly closed, revents = %hd", fds[0].revents);
-						return EXIT_FAILURE;
-					}
-
-					if (wl_display_dispatch(app.wl_display) == -1) {
-						return EXIT_FAILURE;
-					}
-				}
-
-				if (fds[1].revents) {
-					if (!(fds[1].revents & POLLIN)) {
-						wob_log_error("STDIN unexpectedly closed, revents = %hd", fds[1].revents);
-						if (!hidden) wob_hide(&app);
-						wob_destroy(&app);
-
-						return EXIT_FAILURE;
-					}
-
-					fgets_rv = fgets(input_buffer, INPUT_BUFFER_LENGTH, stdin);
-
-					if (feof(stdin)) {
-						wob_log_info("Received EOF");
-						if (!hidden) wob_hide(&app);
-						wob_destroy(&app);
-
-						return EXIT_SUCCESS;
-					}
-
-					if (fgets_rv == NULL) {
-						wob_log_error("fgets() failed: %s", strerror(errno));
-						if (!hidden) wob_hide(&app);
-						wob_destroy(&app);
-
-						return EXIT_FAILURE;
-					}
-
-					if (!wob_parse_input(input_buffer, &percentage, &colors.background, &colors.border, &colors.bar)) {
-						wob_log_error("Received invalid input");
-						if (!hidden) wob_hide(&app);
-						wob_destroy(&app);
-
-						return EXIT_FAILURE;
-					}
-
-					old_colors = effective_colors;
-					if (percentage > maximum) {
-						switch (overflow_mode) {
-							case OVERFLOW_MODE_NONE:
-								wob_log_error("Received value %ld is above defined maximum %ld", percentage, maximum);
-								if (!hidden) wob_hide(&app);
-								wob_destroy(&app);
-								return EXIT_FAILURE;
-							case OVERFLOW_MODE_WRAP:
-								effective_colors = overflow_colors;
-								percentage %= maximum;
-								break;
-							case OVERFLOW_MODE_NOWRAP:
-								effective_colors = overflow_colors;
-								percentage = maximum;
-								break;
-						}
-					}
-					else {
-						effective_colors = colors;
-					}
-
-					wob_log_info(
-						"Received input { value = %ld, bg = %#x, border = %#x, bar = %#x, overflow = %s }",
-						percentage,
-						effective_colors.background,
-						effective_colors.border,
-						effective_colors.bar,
-						overflow_mode == OVERFLOW_MODE_NONE ? "false" : "true"); // how should this be handled w/ the overflow colors?
-
-					if (hidden) {
-						wob_show(&app);
-					}
+			}
 
-					bool redraw_background_and_border = false;
-					if (wob_color_to_argb(old_colors.background) != wob_color_to_argb(effective_colors.background)) {
-						redraw_background_and_border = true;
-					}
-					else if (wob_color_to_argb(old_colors.border) != wob_color_to_argb(effective_colors.border)) {
-						redraw_background_and_border = true;
-					}
+			display_events |= EPOLLOUT;
+		}
 
-					if (redraw_background_and_border) {
-						wob_draw_background(app.wob_geom, argb, effective_colors.background);
-						wob_draw_border(app.wob_geom, argb, effective_colors.border);
-					}
+		if (display_events != app.display_events) {
+			if (!wob_event_loop_modify(&app.event_loop, &app.display_source, display_events)) {
+				return EXIT_FAILURE;
+			}
+			app.display_events = display_events;
+		}
 
-					wob_draw_percentage(app.wob_geom, argb, effective_colors.bar, effective_colors.background, percentage, maximum);
+		if (!wob_event_loop_dispatch(&app.event_loop, wob_render_timeout(&app))) {
+			wob_quit(&app, EXIT_FAILURE);
+		}
+	}
 
-					wob_flush(&app);
-					hidden = false;
-				}
+	wob_input_thread_stop(&app.input_thread);
+	wl_list_for_each (channel, &app.channels, link) {
+		if (!channel->hidden) {
+			wob_hide(channel);
 		}
 	}
+	wob_destroy(&app);
+
+	return app.exit_status;
 }
@@ -1,11 +1,45 @@
 #define WOB_FILE "parse.c"
 
+#define _POSIX_C_SOURCE 200809L
+
+#include <limits.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "parse.h"
 
+#define BYTES(x) (0x0101010101010101ULL * (x))
+
+// decodes 8 ASCII hex digits (first digit in the lowest byte) into 4 bytes, all digits are validated at once
+static bool
+wob_parse_hex_swar(uint64_t chars, uint8_t parts[4])
+{
+	if (chars & BYTES(0x80)) {
+		return false;
+	}
+
+	// all bytes are below 0x80, so adding at most 0x7f to each of them never carries into the next byte
+	// the high bit of a byte is then set when the byte was at least (0x80 - addend)
+	uint64_t digit = (chars + BYTES(0x80 - '0')) & ~(chars + BYTES(0x7f - '9')) & BYTES(0x80);
+	uint64_t lowercase = chars | BYTES(0x20);
+	uint64_t letter = (lowercase + BYTES(0x80 - 'a')) & ~(lowercase + BYTES(0x7f - 'f')) & BYTES(0x80);
+	if ((digit | letter) != BYTES(0x80)) {
+		return false;
+	}
+
+	// low nibble of '0'-'9' is the value, low nibble of 'a'-'f' and 'A'-'F' is the value minus 9
+	uint64_t nibbles = (chars & BYTES(0x0f)) + (letter >> 7) * 9;
+	uint64_t pairs = ((nibbles & 0x000f000f000f000fULL) << 4) | ((nibbles >> 8) & 0x000f000f000f000fULL);
+
+	parts[0] = pairs;
+	parts[1] = pairs >> 16;
+	parts[2] = pairs >> 32;
+	parts[3] = pairs >> 48;
+
+	return true;
+}
+
 bool
 wob_parse_color(const char *restrict str, char **restrict str_end, struct wob_color *color)
 {
@@ -14,24 +48,22 @@ wob_parse_color(const char *restrict str, char **restrict str_end, struct wob_co
 	}
 	str += 1;
 
-	uint8_t parts[4];
-	for (size_t i = 0; i < (sizeof(parts) / sizeof(uint8_t)); ++i) {
-		char *strtoul_end;
-		char buffer[3] = {0};
+	// never read past the end of the string
+	if (strnlen(str, 8) != 8) {
+		return false;
+	}
 
-		strncpy(buffer, &str[i * 2], 2);
-		parts[i] = strtoul(buffer, &strtoul_end, 16);
-		if (strtoul_end != buffer + 2) {
-			return false;
-		}
+	uint64_t chars = 0;
+	for (size_t i = 0; i < 8; ++i) {
+		chars |= (uint64_t) (unsigned char) str[i] << (i * 8);
 	}
 
-	*color = (struct wob_color){
-		.r = (float) parts[0] / UINT8_MAX,
-		.g = (float) parts[1] / UINT8_MAX,
-		.b = (float) parts[2] / UINT8_MAX,
-		.a = (float) parts[3] / UINT8_MAX,
-	};
+	uint8_t parts[4];
+	if (!wob_parse_hex_swar(chars, parts)) {
+		return false;
+	}
+
+	*color = wob_color_from_argb((uint32_t) parts[3] << 24 | (uint32_t) parts[0] << 16 | (uint32_t) parts[1] << 8 | parts[2]);
 
 	if (str_end) {
 		*str_end = ((char *) str) + sizeof("FFFFFFFF") - 1;
@@ -43,19 +75,23 @@ wob_parse_color(const char *restrict str, char **restrict str_end, struct wob_co
 bool
 wob_parse_input(const char *input_buffer, unsigned long *percentage, struct wob_color *background_color, struct wob_color *border_color, struct wob_color *bar_color)
 {
-	char *input_ptr, *newline_position, *str_end;
+	const char *input_ptr = input_buffer;
+	char *str_end;
 
-	newline_position = strchr(input_buffer, '\n');
-	if (newline_position == NULL) {
-		return false;
+	unsigned long value = 0;
+	for (unsigned digit; (digit = (unsigned char) *input_ptr - '0') < 10; ++input_ptr) {
+		if (value > (ULONG_MAX - digit) / 10) {
+			return false;
+		}
+		value = value * 10 + digit;
 	}
 
-	if (newline_position == input_buffer) {
+	if (input_ptr == input_buffer) {
 		return false;
 	}
 
-	*percentage = strtoul(input_buffer, &input_ptr, 10);
-	if (input_ptr == newline_position) {
+	*percentage = value;
+	if (input_ptr[0] == '\n') {
 		return true;
 	}
 
@@ -78,5 +114,75 @@ wob_parse_input(const char *input_buffer, unsigned long *percentage, struct wob_
 		input_ptr = str_end;
 	}
 
-	return input_ptr == newline_position;
+	return input_ptr[0] == '\n';
+}
+
+bool
+wob_parse_command(
+	const char *input_buffer, enum wob_command *command, unsigned long *percentage, struct wob_color *background_color, struct wob_color *border_color, struct wob_color *bar_color)
+{
+	static const struct {
+		const char *line;
+		enum wob_command command;
+	} keywords[] = {
+		{"show\n", WOB_COMMAND_SHOW},
+		{"hide\n", WOB_COMMAND_HIDE},
+		{"refresh-timeout\n", WOB_COMMAND_REFRESH_TIMEOUT},
+	};
+
+	switch (input_buffer[0]) {
+		case '+':
+			*command = WOB_COMMAND_INCREASE;
+			return wob_parse_input(input_buffer + 1, percentage, background_color, border_color, bar_color);
+		case '-':
+			*command = WOB_COMMAND_DECREASE;
+			return wob_parse_input(input_buffer + 1, percentage, background_color, border_color, bar_color);
+	}
+
+	for (size_t i = 0; i < sizeof(keywords) / sizeof(keywords[0]); ++i) {
+		if (strncmp(input_buffer, keywords[i].line, strlen(keywords[i].line)) == 0) {
+			// commands take no value, but the input thread still queues one along with them
+			*command = keywords[i].command;
+			*percentage = 0;
+			return true;
+		}
+	}
+
+	*command = WOB_COMMAND_SET;
+	return wob_parse_input(input_buffer, percentage, background_color, border_color, bar_color);
+}
+
+static uint32_t
+wob_read_u32_le(const unsigned char *bytes)
+{
+	return (uint32_t) bytes[0] | (uint32_t) bytes[1] << 8 | (uint32_t) bytes[2] << 16 | (uint32_t) bytes[3] << 24;
+}
+
+bool
+wob_parse_binary_input(
+	const unsigned char *frame, enum wob_command *command, unsigned long *percentage, struct wob_color *background_color, struct wob_color *border_color, struct wob_color *bar_color)
+{
+	uint8_t flags = frame[16];
+	if ((flags & ~WOB_BINARY_INPUT_FLAG_COLORS) != 0 || frame[17] > WOB_COMMAND_REFRESH_TIMEOUT || frame[18] != 0 || frame[19] != 0) {
+		return false;
+	}
+
+	*command = frame[17];
+
+	*percentage = wob_read_u32_le(&frame[0]);
+	if (!(flags & WOB_BINARY_INPUT_FLAG_COLORS)) {
+		return true;
+	}
+
+	struct wob_color *colors_to_parse[3] = {
+		background_color,
+		border_color,
+		bar_color,
+	};
+
+	for (size_t i = 0; i < sizeof(colors_to_parse) / sizeof(struct wob_color *); ++i) {
+		*colors_to_parse[i] = wob_color_from_argb(wob_read_u32_le(&frame[4 + i * 4]));
+	}
+
+	return true;
 }
@@ -3,7 +3,7 @@
 #include "pledge.h"
 
 bool
-wob_pledge(void)
+wob_pledge(bool watch_files, bool remove_socket)
 {
 	return true;
 }
@@ -1,9 +1,12 @@
 #define WOB_FILE "pledge_seccomp.c"
 
+#include <errno.h>
+#include <fcntl.h>
 #include <stdlib.h>
 
 #include <linux/audit.h>
 #include <linux/filter.h>
+#include <linux/sched.h>
 #include <linux/seccomp.h>
 #include <linux/signal.h>
 #include <seccomp.h>
@@ -13,34 +16,64 @@
 #include "pledge.h"
 
 bool
-wob_pledge(void)
+wob_pledge(bool watch_files, bool remove_socket)
 {
 	const int scmp_sc[] = {
+		SCMP_SYS(accept4),
+		SCMP_SYS(brk),
 		SCMP_SYS(clock_gettime),
 		SCMP_SYS(close),
+		SCMP_SYS(epoll_ctl),
+		SCMP_SYS(epoll_pwait),
+		SCMP_SYS(epoll_wait),
 		SCMP_SYS(exit),
 		SCMP_SYS(exit_group),
+		SCMP_SYS(fallocate),
 		SCMP_SYS(fcntl),
+		SCMP_SYS(fstat),
+		SCMP_SYS(ftruncate),
+		SCMP_SYS(futex),
 		SCMP_SYS(gettimeofday),
+		SCMP_SYS(memfd_create),
+		SCMP_SYS(mmap),
+		SCMP_SYS(mprotect),
 		SCMP_SYS(munmap),
+		SCMP_SYS(newfstatat),
 		SCMP_SYS(poll),
 		SCMP_SYS(ppoll),
+		SCMP_SYS(pread64),
 		SCMP_SYS(read),
 		SCMP_SYS(readv),
 		SCMP_SYS(recvmsg),
 		SCMP_SYS(restart_syscall),
+		SCMP_SYS(rseq),
+		SCMP_SYS(rt_sigprocmask),
 		SCMP_SYS(sendmsg),
+		SCMP_SYS(set_robust_list),
+		SCMP_SYS(timerfd_settime),
 		SCMP_SYS(write),
 		SCMP_SYS(writev),
 	};
 
 	int ret;
+#ifdef SCMP_ACT_KILL_PROCESS
+	// a killed input thread would otherwise leave wob running without input
+	scmp_filter_ctx scmp_ctx = seccomp_init(SCMP_ACT_KILL_PROCESS);
+#else
 	scmp_filter_ctx scmp_ctx = seccomp_init(SCMP_ACT_KILL);
+#endif
 	if (scmp_ctx == NULL) {
 		wob_log_error("seccomp_init(SCMP_ACT_KILL) failed");
 		return false;
 	}
 
+	// input thread is already running, the filter has to cover it too
+	if ((ret = seccomp_attr_set(scmp_ctx, SCMP_FLTATR_CTL_TSYNC, 1)) < 0) {
+		wob_log_error("seccomp_attr_set(scmp_ctx, SCMP_FLTATR_CTL_TSYNC, 1) failed with return value %d", ret);
+		seccomp_release(scmp_ctx);
+		return false;
+	}
+
 	for (size_t i = 0; i < sizeof(scmp_sc) / sizeof(int); ++i) {
 		wob_log_debug("Adding syscall %d to whitelist", scmp_sc[i]);
 		if ((ret = seccomp_rule_add(scmp_ctx, SCMP_ACT_ALLOW, scmp_sc[i], 0)) < 0) {
@@ -50,6 +83,58 @@ wob_pledge(void)
 		}
 	}
 
+	// watched files replaced by a rename are opened again, for reading only
+	if (watch_files) {
+		const int watch_sc[] = {
+			SCMP_SYS(inotify_add_watch),
+			SCMP_SYS(inotify_rm_watch),
+		};
+
+		for (size_t i = 0; i < sizeof(watch_sc) / sizeof(int); ++i) {
+			if ((ret = seccomp_rule_add(scmp_ctx, SCMP_ACT_ALLOW, watch_sc[i], 0)) < 0) {
+				wob_log_error("seccomp_rule_add(scmp_ctx, SCMP_ACT_ALLOW, %d) failed with return value %d", watch_sc[i], ret);
+				seccomp_release(scmp_ctx);
+				return false;
+			}
+		}
+
+		if ((ret = seccomp_rule_add(scmp_ctx, SCMP_ACT_ALLOW, SCMP_SYS(openat), 1, SCMP_A2(SCMP_CMP_MASKED_EQ, O_ACCMODE | O_CREAT | O_TRUNC, O_RDONLY))) < 0) {
+			wob_log_error("seccomp_rule_add(scmp_ctx, SCMP_ACT_ALLOW, openat) failed with return value %d", ret);
+			seccomp_release(scmp_ctx);
+			return false;
+		}
+	}
+
+	// socket bound by wob is removed on exit
+	if (remove_socket) {
+		const int socket_sc[] = {
+			SCMP_SYS(unlink),
+			SCMP_SYS(unlinkat),
+		};
+
+		for (size_t i = 0; i < sizeof(socket_sc) / sizeof(int); ++i) {
+			if ((ret = seccomp_rule_add(scmp_ctx, SCMP_ACT_ALLOW, socket_sc[i], 0)) < 0) {
+				wob_log_error("seccomp_rule_add(scmp_ctx, SCMP_ACT_ALLOW, %d) failed with return value %d", socket_sc[i], ret);
+				seccomp_release(scmp_ctx);
+				return false;
+			}
+		}
+	}
+
+	// render workers are spawned on demand, clone is only allowed to create threads
+	if ((ret = seccomp_rule_add(scmp_ctx, SCMP_ACT_ALLOW, SCMP_SYS(clone), 1, SCMP_A0(SCMP_CMP_MASKED_EQ, CLONE_THREAD, CLONE_THREAD))) < 0) {
+		wob_log_error("seccomp_rule_add(scmp_ctx, SCMP_ACT_ALLOW, clone) failed with return value %d", ret);
+		seccomp_release(scmp_ctx);
+		return false;
+	}
+
+	// flags of clone3 are out of reach of the filter, libc falls back to clone
+	if ((ret = seccomp_rule_add(scmp_ctx, SCMP_ACT_ERRNO(ENOSYS), SCMP_SYS(clone3), 0)) < 0) {
+		wob_log_error("seccomp_rule_add(scmp_ctx, SCMP_ACT_ERRNO(ENOSYS), clone3) failed with return value %d", ret);
+		seccomp_release(scmp_ctx);
+		return false;
+	}
+
 	if ((ret = seccomp_load(scmp_ctx)) < 0) {
 		wob_log_error("seccomp_load(scmp_ctx) failed with return value %d", ret);
 		seccomp_release(scmp_ctx);
@@ -0,0 +1,106 @@
+#define WOB_FILE "pool.c"
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <string.h>
+
+#include "log.h"
+#include "pool.h"
+
+bool
+wob_pool_init(struct wob_pool *pool, size_t max_workers)
+{
+	memset(pool, 0, sizeof(*pool));
+	pool->max_workers = max_workers < WOB_POOL_MAX_WORKERS ? max_workers : WOB_POOL_MAX_WORKERS;
+
+	if (pthread_mutex_init(&pool->mutex, NULL) != 0 || pthread_cond_init(&pool->work, NULL) != 0 || pthread_cond_init(&pool->done, NULL) != 0) {
+		wob_log_error("Failed to initialize worker pool");
+		return false;
+	}
+
+	return true;
+}
+
+// takes jobs until there are none left, called with the mutex held
+void
+wob_pool_work(struct wob_pool *pool)
+{
+	while (pool->next < pool->job_count) {
+		size_t index = pool->next++;
+		pthread_mutex_unlock(&pool->mutex);
+
+		pool->run(pool->data, index);
+
+		pthread_mutex_lock(&pool->mutex);
+		if (++pool->finished == pool->job_count) {
+			pthread_cond_signal(&pool->done);
+		}
+	}
+}
+
+void *
+wob_pool_worker(void *data)
+{
+	struct wob_pool *pool = data;
+
+	pthread_mutex_lock(&pool->mutex);
+	while (!pool->stop) {
+		wob_pool_work(pool);
+		pthread_cond_wait(&pool->work, &pool->mutex);
+	}
+	pthread_mutex_unlock(&pool->mutex);
+
+	return NULL;
+}
+
+void
+wob_pool_run(struct wob_pool *pool, void (*run)(void *data, size_t index), void *data, size_t job_count)
+{
+	pthread_mutex_lock(&pool->mutex);
+
+	// the calling thread takes jobs too, so one worker less is enough
+	while (pool->worker_count < pool->max_workers && pool->worker_count + 1 < job_count) {
+		int error = pthread_create(&pool->workers[pool->worker_count], NULL, wob_pool_worker, pool);
+		if (error != 0) {
+			wob_log_error("pthread_create() failed: %s", strerror(error));
+			pool->max_workers = pool->worker_count;
+			break;
+		}
+
+		pool->worker_count += 1;
+		wob_log_debug("Spawned render worker %zu", pool->worker_count);
+	}
+
+	pool->run = run;
+	pool->data = data;
+	pool->job_count = job_count;
+	pool->next = 0;
+	pool->finished = 0;
+	pthread_cond_broadcast(&pool->work);
+
+	wob_pool_work(pool);
+	while (pool->finished < pool->job_count) {
+		pthread_cond_wait(&pool->done, &pool->mutex);
+	}
+
+	pool->job_count = 0;
+	pool->next = 0;
+	pthread_mutex_unlock(&pool->mutex);
+}
+
+void
+wob_pool_finish(struct wob_pool *pool)
+{
+	pthread_mutex_lock(&pool->mutex);
+	pool->stop = true;
+	pthread_cond_broadcast(&pool->work);
+	pthread_mutex_unlock(&pool->mutex);
+
+	for (size_t i = 0; i < pool->worker_count; ++i) {
+		pthread_join(pool->workers[i], NULL);
+	}
+
+	pthread_mutex_destroy(&pool->mutex);
+	pthread_cond_destroy(&pool->work);
+	pthread_cond_destroy(&pool->done);
+}
@@ -0,0 +1,42 @@
+#define WOB_FILE "queue.c"
+
+#include "queue.h"
+
+void
+wob_queue_init(struct wob_queue *queue)
+{
+	queue->head = 0;
+	queue->tail = 0;
+}
+
+bool
+wob_queue_push(struct wob_queue *queue, const struct wob_update *update)
+{
+	size_t tail = queue->tail;
+	size_t head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+	if (tail - head == WOB_QUEUE_CAPACITY) {
+		return false;
+	}
+
+	queue->updates[tail % WOB_QUEUE_CAPACITY] = *update;
+	// publishes the slot, the consumer may read it from now on
+	__atomic_store_n(&queue->tail, tail + 1, __ATOMIC_RELEASE);
+
+	return true;
+}
+
+bool
+wob_queue_pop(struct wob_queue *queue, struct wob_update *update)
+{
+	size_t head = queue->head;
+	size_t tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+	if (head == tail) {
+		return false;
+	}
+
+	*update = queue->updates[head % WOB_QUEUE_CAPACITY];
+	// hands the slot back, the producer may overwrite it from now on
+	__atomic_store_n(&queue->head, head + 1, __ATOMIC_RELEASE);
+
+	return true;
+}
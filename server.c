@@ -0,0 +1,175 @@
+#define WOB_FILE "server.c"
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "log.h"
+#include "server.h"
+#include "shm.h"
+
+int
+wob_server_listen(const char *path)
+{
+	struct sockaddr_un address = {.sun_family = AF_UNIX};
+	if (strlen(path) >= sizeof(address.sun_path)) {
+		wob_log_error("Socket path %s is too long", path);
+		return -1;
+	}
+	strcpy(address.sun_path, path);
+
+	int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (fd == -1) {
+		wob_log_error("socket() failed: %s", strerror(errno));
+		return -1;
+	}
+
+	// socket left behind by a previous instance, anything else at the path is not ours to remove
+	struct stat st;
+	if (lstat(path, &st) == 0 && S_ISSOCK(st.st_mode)) {
+		// a full backlog still means somebody listens
+		int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+		bool listening = probe != -1 && (connect(probe, (struct sockaddr *) &address, sizeof(address)) == 0 || errno == EAGAIN);
+		if (probe != -1) {
+			close(probe);
+		}
+
+		if (listening) {
+			wob_log_error("Another instance is already listening on %s", path);
+			close(fd);
+			return -1;
+		}
+
+		unlink(path);
+	}
+
+	if (bind(fd, (struct sockaddr *) &address, sizeof(address)) == -1) {
+		wob_log_error("bind() to %s failed: %s", path, strerror(errno));
+		close(fd);
+		return -1;
+	}
+
+	if (listen(fd, SOMAXCONN) == -1) {
+		wob_log_error("listen() on %s failed: %s", path, strerror(errno));
+		close(fd);
+		return -1;
+	}
+
+	wob_log_info("Listening on %s", path);
+
+	return fd;
+}
+
+int
+wob_server_listen_fds(void)
+{
+	const char *listen_pid = getenv("LISTEN_PID");
+	const char *listen_fds = getenv("LISTEN_FDS");
+	if (listen_pid == NULL || listen_fds == NULL) {
+		return 0;
+	}
+
+	// the variables are meant for the process the service manager started, not for its children
+	char *end;
+	long pid = strtol(listen_pid, &end, 10);
+	if (*end != '\0' || pid != getpid()) {
+		return 0;
+	}
+
+	long count = strtol(listen_fds, &end, 10);
+	if (*end != '\0' || count <= 0) {
+		return 0;
+	}
+
+	unsetenv("LISTEN_PID");
+	unsetenv("LISTEN_FDS");
+	unsetenv("LISTEN_FDNAMES");
+
+	return count;
+}
+
+bool
+wob_server_adopt(int fd)
+{
+	// a FIFO passed along with StandardInput=socket is read through STDIN instead
+	int accepting = 0;
+	socklen_t length = sizeof(accepting);
+	if (getsockopt(fd, SOL_SOCKET, SO_ACCEPTCONN, &accepting, &length) == -1 || !accepting) {
+		wob_log_debug("File descriptor %d passed by the service manager is not a listening socket, ignoring it", fd);
+		return false;
+	}
+
+	int flags = fcntl(fd, F_GETFL);
+	if (flags == -1 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1 || fcntl(fd, F_SETFD, FD_CLOEXEC) == -1) {
+		wob_log_error("fcntl() failed: %s", strerror(errno));
+		return false;
+	}
+
+	wob_log_info("Listening on socket %d passed by the service manager", fd);
+
+	return true;
+}
+
+int
+wob_server_accept(int listen_fd)
+{
+	int fd = accept4(listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+	if (fd == -1 && errno != EAGAIN && errno != EWOULDBLOCK && errno != ECONNABORTED && errno != EINTR) {
+		wob_log_error("accept4() failed: %s", strerror(errno));
+	}
+
+	return fd;
+}
+
+const struct wob_shm *
+wob_server_map_shm(int memfd)
+{
+	// producer must not be able to shrink the region, reading it would raise SIGBUS
+	int seals = fcntl(memfd, F_GET_SEALS);
+	if (seals == -1 || !(seals & F_SEAL_SHRINK)) {
+		wob_log_error("Shared memory region %d is not sealed against shrinking", memfd);
+		return NULL;
+	}
+
+	struct stat st;
+	if (fstat(memfd, &st) == -1 || st.st_size < (off_t) sizeof(struct wob_shm)) {
+		wob_log_error("Shared memory region %d is too small", memfd);
+		return NULL;
+	}
+
+	const struct wob_shm *shm = mmap(NULL, sizeof(struct wob_shm), PROT_READ, MAP_SHARED, memfd, 0);
+	if (shm == MAP_FAILED) {
+		wob_log_error("mmap() failed: %s", strerror(errno));
+		return NULL;
+	}
+
+	if (shm->magic != WOB_SHM_MAGIC) {
+		wob_log_error("Shared memory region %d has unknown magic %#x", memfd, shm->magic);
+		munmap((void *) shm, sizeof(struct wob_shm));
+		return NULL;
+	}
+
+	return shm;
+}
+
+void
+wob_server_unmap_shm(const struct wob_shm *shm)
+{
+	munmap((void *) shm, sizeof(struct wob_shm));
+}
+
+void
+wob_server_shm_colors(const struct wob_shm_snapshot *snapshot, struct wob_color *background, struct wob_color *border, struct wob_color *bar)
+{
+	*background = wob_color_from_argb(snapshot->background);
+	*border = wob_color_from_argb(snapshot->border);
+	*bar = wob_color_from_argb(snapshot->bar);
+}
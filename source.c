@@ -0,0 +1,201 @@
+#define WOB_FILE "source.c"
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "log.h"
+#include "source.h"
+
+// longest number wob reads from a watched file, sysfs attributes are far shorter
+#define WOB_SOURCE_BUFFER_SIZE 64
+
+struct wob_expression {
+	const char *position;
+	long long value;
+	long long max;
+};
+
+bool wob_expression_sum(struct wob_expression *expression, long long *result);
+
+void
+wob_expression_skip_spaces(struct wob_expression *expression)
+{
+	while (isspace((unsigned char) *expression->position)) {
+		expression->position += 1;
+	}
+}
+
+bool
+wob_expression_keyword(struct wob_expression *expression, const char *keyword)
+{
+	size_t length = strlen(keyword);
+	if (strncmp(expression->position, keyword, length) != 0 || isalnum((unsigned char) expression->position[length])) {
+		return false;
+	}
+
+	expression->position += length;
+	return true;
+}
+
+bool
+wob_expression_factor(struct wob_expression *expression, long long *result)
+{
+	wob_expression_skip_spaces(expression);
+
+	if (*expression->position == '-') {
+		expression->position += 1;
+		if (!wob_expression_factor(expression, result)) {
+			return false;
+		}
+		return !__builtin_sub_overflow(0, *result, result);
+	}
+
+	if (*expression->position == '(') {
+		expression->position += 1;
+		if (!wob_expression_sum(expression, result)) {
+			return false;
+		}
+
+		wob_expression_skip_spaces(expression);
+		if (*expression->position != ')') {
+			return false;
+		}
+		expression->position += 1;
+		return true;
+	}
+
+	if (wob_expression_keyword(expression, "value")) {
+		*result = expression->value;
+		return true;
+	}
+
+	if (wob_expression_keyword(expression, "max")) {
+		*result = expression->max;
+		return true;
+	}
+
+	if (!isdigit((unsigned char) *expression->position)) {
+		return false;
+	}
+
+	char *end;
+	errno = 0;
+	*result = strtoll(expression->position, &end, 10);
+	expression->position = end;
+
+	return errno != ERANGE;
+}
+
+bool
+wob_expression_product(struct wob_expression *expression, long long *result)
+{
+	if (!wob_expression_factor(expression, result)) {
+		return false;
+	}
+
+	while (true) {
+		wob_expression_skip_spaces(expression);
+		char symbol = *expression->position;
+		if (symbol != '*' && symbol != '/' && symbol != '%') {
+			return true;
+		}
+		expression->position += 1;
+
+		long long operand;
+		if (!wob_expression_factor(expression, &operand)) {
+			return false;
+		}
+
+		// overflows and division by zero make the whole expression invalid
+		if (symbol == '*') {
+			if (__builtin_mul_overflow(*result, operand, result)) {
+				return false;
+			}
+		}
+		else if (operand == 0 || (operand == -1 && *result == LLONG_MIN)) {
+			return false;
+		}
+		else if (symbol == '/') {
+			*result /= operand;
+		}
+		else {
+			*result %= operand;
+		}
+	}
+}
+
+bool
+wob_expression_sum(struct wob_expression *expression, long long *result)
+{
+	if (!wob_expression_product(expression, result)) {
+		return false;
+	}
+
+	while (true) {
+		wob_expression_skip_spaces(expression);
+		char symbol = *expression->position;
+		if (symbol != '+' && symbol != '-') {
+			return true;
+		}
+		expression->position += 1;
+
+		long long operand;
+		if (!wob_expression_product(expression, &operand)) {
+			return false;
+		}
+
+		if (symbol == '+' ? __builtin_add_overflow(*result, operand, result) : __builtin_sub_overflow(*result, operand, result)) {
+			return false;
+		}
+	}
+}
+
+// integer arithmetic with + - * / % and parentheses over the variables value and max
+bool
+wob_source_eval(const char *expression, long long value, long long max, long long *result)
+{
+	struct wob_expression state = {
+		.position = expression,
+		.value = value,
+		.max = max,
+	};
+
+	if (!wob_expression_sum(&state, result)) {
+		return false;
+	}
+
+	wob_expression_skip_spaces(&state);
+	return *state.position == '\0';
+}
+
+// files are read from the start every time, sysfs attributes only ever return a fresh value that way
+bool
+wob_source_read(int fd, long long *value)
+{
+	char buffer[WOB_SOURCE_BUFFER_SIZE + 1];
+	ssize_t length = pread(fd, buffer, WOB_SOURCE_BUFFER_SIZE, 0);
+	if (length == -1) {
+		wob_log_error("pread() failed: %s", strerror(errno));
+		return false;
+	}
+	buffer[length] = '\0';
+
+	char *end;
+	errno = 0;
+	*value = strtoll(buffer, &end, 10);
+	if (end == buffer || errno == ERANGE) {
+		return false;
+	}
+
+	while (isspace((unsigned char) *end)) {
+		end += 1;
+	}
+
+	return *end == '\0';
+}
@@ -0,0 +1,81 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "animation.h"
+
+int
+main(int argc, char **argv)
+{
+	struct wob_animation animation = {.easing = WOB_EASING_LINEAR, .duration_msec = 100};
+	struct timespec now = {.tv_sec = 10};
+
+	printf("running 1\n");
+	wob_animation_start(&animation, 0.5, &now);
+	if (!animation.running || animation.from != 0 || wob_animation_position(&animation, &now) != 0) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 2\n");
+	now.tv_nsec = 50 * 1000000L;
+	if (wob_animation_position(&animation, &now) != 0.25 || wob_animation_finished(&animation, &now)) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 3\n");
+	// retargeted halfway, starts from where the fill is shown
+	wob_animation_start(&animation, 1, &now);
+	if (!animation.running || animation.from != 0.25) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 4\n");
+	now.tv_nsec = 150 * 1000000L;
+	if (wob_animation_position(&animation, &now) != 1 || !wob_animation_finished(&animation, &now)) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 5\n");
+	animation.running = false;
+	wob_animation_start(&animation, 1, &now);
+	if (animation.running) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 6\n");
+	animation.easing = WOB_EASING_EASE_OUT;
+	wob_animation_start(&animation, 0, &now);
+	now.tv_nsec = 200 * 1000000L;
+	if (!animation.running || wob_animation_position(&animation, &now) != 0.125) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 7\n");
+	animation.duration_msec = 0;
+	wob_animation_start(&animation, 0.5, &now);
+	if (animation.running || wob_animation_position(&animation, &now) != 0.5) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 8\n");
+	// bar shown again after being hidden does not animate from the value it showed before
+	animation.duration_msec = 100;
+	wob_animation_start(&animation, 0.75, &now);
+	wob_animation_jump(&animation, 0.25);
+	if (animation.running || wob_animation_position(&animation, &now) != 0.25) {
+		return EXIT_FAILURE;
+	}
+	wob_animation_start(&animation, 0.5, &now);
+	if (!animation.running || animation.from != 0.25) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 9\n");
+	enum wob_easing easing;
+	if (!wob_parse_easing("ease-in-out", &easing) || easing != WOB_EASING_EASE_IN_OUT || wob_parse_easing("bounce", &easing)) {
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,106 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "fill.h"
+
+#define CANVAS_SIZE (WOB_FILL_NON_TEMPORAL_THRESHOLD / 4 + 1024)
+#define GUARD 0xDEADBEEF
+
+static uint32_t canvas[CANVAS_SIZE];
+
+static void
+reset(void)
+{
+	for (size_t i = 0; i < CANVAS_SIZE; ++i) {
+		canvas[i] = GUARD;
+	}
+}
+
+static int
+check_span(size_t start, size_t count, uint32_t value)
+{
+	for (size_t i = 0; i < CANVAS_SIZE; ++i) {
+		uint32_t expected = i >= start && i < start + count ? value : GUARD;
+		if (canvas[i] != expected) {
+			fprintf(stderr, "pixel %zu is %#x, expected %#x\n", i, canvas[i], expected);
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+	printf("running 1\n");
+	// every alignment and tail length of vector stores
+	for (size_t start = 0; start < 9; ++start) {
+		for (size_t count = 0; count < 40; ++count) {
+			reset();
+			wob_fill(canvas + start, 0xFF16A085, count);
+			if (check_span(start, count, 0xFF16A085)) {
+				return EXIT_FAILURE;
+			}
+		}
+	}
+
+	printf("running 2\n");
+	// large enough for non-temporal stores
+	reset();
+	wob_fill(canvas + 3, 0xFF000000, CANVAS_SIZE - 1000);
+	if (check_span(3, CANVAS_SIZE - 1000, 0xFF000000)) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 3\n");
+	const size_t stride = 37;
+	reset();
+	wob_fill_rect(canvas + stride + 5, stride, 11, 7, 0xFFFFFFFF);
+	for (size_t y = 0; y < 10; ++y) {
+		for (size_t x = 0; x < stride; ++x) {
+			bool inside = y >= 1 && y < 8 && x >= 5 && x < 16;
+			if (canvas[y * stride + x] != (inside ? 0xFFFFFFFF : GUARD)) {
+				return EXIT_FAILURE;
+			}
+		}
+	}
+
+	printf("running 4\n");
+	reset();
+	for (size_t x = 0; x < 29; ++x) {
+		canvas[stride + 2 + x] = x;
+	}
+	wob_replicate_row(canvas + stride + 2, stride, 29, 5);
+	for (size_t y = 0; y < 8; ++y) {
+		for (size_t x = 0; x < stride; ++x) {
+			bool inside = y >= 1 && y < 6 && x >= 2 && x < 31;
+			if (canvas[y * stride + x] != (inside ? x - 2 : GUARD)) {
+				return EXIT_FAILURE;
+			}
+		}
+	}
+
+	printf("running 5\n");
+	// rows spanning the whole stride, large enough for non-temporal stores
+	const size_t wide = 4000;
+	const size_t rows = (CANVAS_SIZE - 1000) / wide;
+	reset();
+	for (size_t x = 0; x < wide; ++x) {
+		canvas[x] = x * 7;
+	}
+	wob_replicate_row(canvas, wide, wide, rows);
+	for (size_t i = 0; i < wide * rows; ++i) {
+		if (canvas[i] != (i % wide) * 7) {
+			return EXIT_FAILURE;
+		}
+	}
+	for (size_t i = wide * rows; i < CANVAS_SIZE; ++i) {
+		if (canvas[i] != GUARD) {
+			return EXIT_FAILURE;
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
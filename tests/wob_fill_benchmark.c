@@ -0,0 +1,40 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "fill.h"
+
+#define ITERATIONS 2000
+// 4K wide bar at scale 2
+#define WIDTH (3840 * 2)
+#define HEIGHT (50 * 2)
+
+int
+main(int argc, char **argv)
+{
+	uint32_t *argb = malloc(WIDTH * HEIGHT * sizeof(uint32_t));
+	if (argb == NULL) {
+		return EXIT_FAILURE;
+	}
+
+	struct timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	for (size_t i = 0; i < ITERATIONS; ++i) {
+		// background, then bar with a 4px border and padding
+		wob_fill(argb, 0xFF000000, WIDTH * HEIGHT);
+		wob_fill(argb + 8 * WIDTH + 8, 0xFFFFFFFF + i, WIDTH - 16);
+		wob_replicate_row(argb + 8 * WIDTH + 8, WIDTH, WIDTH - 16, HEIGHT - 16);
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+	printf("drew %d frames of %dx%d in %.3f s, %.1f us/frame (checksum %#x)\n", ITERATIONS, WIDTH, HEIGHT, seconds, seconds * 1e6 / ITERATIONS, argb[WIDTH * HEIGHT / 2]);
+
+	free(argb);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,70 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "input.h"
+
+int
+main(int argc, char **argv)
+{
+	struct wob_input input;
+	enum wob_input_status status;
+	char *line;
+	int fds[2];
+
+	if (pipe(fds) != 0 || !wob_input_init(&input, fds[0])) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 1\n");
+	status = wob_input_fill(&input);
+	if (status != WOB_INPUT_AGAIN || wob_input_next_line(&input) != NULL) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 2\n");
+	const char *data = "10\n20\n3";
+	if (write(fds[1], data, strlen(data)) != (ssize_t) strlen(data)) {
+		return EXIT_FAILURE;
+	}
+	status = wob_input_fill(&input);
+	if (status != WOB_INPUT_AGAIN) {
+		return EXIT_FAILURE;
+	}
+	line = wob_input_next_line(&input);
+	if (line == NULL || strncmp(line, "10\n", 3) != 0) {
+		return EXIT_FAILURE;
+	}
+	line = wob_input_next_line(&input);
+	if (line == NULL || strncmp(line, "20\n", 3) != 0) {
+		return EXIT_FAILURE;
+	}
+	if (wob_input_next_line(&input) != NULL) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 3\n");
+	data = "0\n";
+	if (write(fds[1], data, strlen(data)) != (ssize_t) strlen(data)) {
+		return EXIT_FAILURE;
+	}
+	close(fds[1]);
+	status = wob_input_fill(&input);
+	if (status != WOB_INPUT_EOF) {
+		return EXIT_FAILURE;
+	}
+	line = wob_input_next_line(&input);
+	if (line == NULL || strcmp(line, "30\n") != 0) {
+		return EXIT_FAILURE;
+	}
+	if (wob_input_next_line(&input) != NULL) {
+		return EXIT_FAILURE;
+	}
+
+	close(fds[0]);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,60 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "parse.h"
+
+int
+main(int argc, char **argv)
+{
+	enum wob_command command;
+	unsigned long percentage;
+	struct wob_color background = {0};
+	struct wob_color border = {0};
+	struct wob_color bar = {0};
+	bool result;
+
+	printf("running 1\n");
+	const unsigned char frame_value[WOB_BINARY_INPUT_FRAME_SIZE] = {25, 0, 0, 0};
+	result = wob_parse_binary_input(frame_value, &command, &percentage, &background, &border, &bar);
+	if (!result || command != WOB_COMMAND_SET || percentage != 25 || background.argb != 0) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 2\n");
+	// 300, 0xFF000000, 0xFFFFFFFF, 0xFF16a085
+	const unsigned char frame_colors[WOB_BINARY_INPUT_FRAME_SIZE] = {0x2C, 0x01, 0, 0, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x85, 0xa0, 0x16, 0xFF, WOB_BINARY_INPUT_FLAG_COLORS};
+	result = wob_parse_binary_input(frame_colors, &command, &percentage, &background, &border, &bar);
+	if (!result || percentage != 300 || background.argb != 0xFF000000 || border.argb != 0xFFFFFFFF || bar.argb != 0xFF16a085) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 3\n");
+	const unsigned char frame_unknown_flag[WOB_BINARY_INPUT_FRAME_SIZE] = {25, 0, 0, 0, [16] = 0x02};
+	result = wob_parse_binary_input(frame_unknown_flag, &command, &percentage, &background, &border, &bar);
+	if (result) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 4\n");
+	const unsigned char frame_reserved[WOB_BINARY_INPUT_FRAME_SIZE] = {25, 0, 0, 0, [19] = 1};
+	result = wob_parse_binary_input(frame_reserved, &command, &percentage, &background, &border, &bar);
+	if (result) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 5\n");
+	const unsigned char frame_increase[WOB_BINARY_INPUT_FRAME_SIZE] = {5, 0, 0, 0, [17] = WOB_COMMAND_INCREASE};
+	result = wob_parse_binary_input(frame_increase, &command, &percentage, &background, &border, &bar);
+	if (!result || command != WOB_COMMAND_INCREASE || percentage != 5) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 6\n");
+	const unsigned char frame_unknown_command[WOB_BINARY_INPUT_FRAME_SIZE] = {5, 0, 0, 0, [17] = WOB_COMMAND_REFRESH_TIMEOUT + 1};
+	result = wob_parse_binary_input(frame_unknown_command, &command, &percentage, &background, &border, &bar);
+	if (result) {
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -7,6 +7,7 @@
 int
 main(int argc, char **argv)
 {
+	enum wob_command command;
 	unsigned long percentage;
 	struct wob_color background = {0};
 	struct wob_color border = {0};
@@ -17,7 +18,7 @@ main(int argc, char **argv)
 	printf("running 1\n");
 	input = "25 #000000FF #FFFFFFFF #FFFFFFFF\n";
 	result = wob_parse_input(input, &percentage, &background, &border, &bar);
-	if (!result || percentage != 25 || wob_color_to_argb(background) != 0xFF000000 || wob_color_to_argb(border) != 0xFFFFFFFF || wob_color_to_argb(bar) != 0xFFFFFFFF) {
+	if (!result || percentage != 25 || background.argb != 0xFF000000 || border.argb != 0xFFFFFFFF || bar.argb != 0xFFFFFFFF) {
 		return EXIT_FAILURE;
 	}
 
@@ -45,7 +46,78 @@ main(int argc, char **argv)
 	printf("running 5\n");
 	input = "25 #000000FF #16a085FF #FF0000FF\n";
 	result = wob_parse_input(input, &percentage, &background, &border, &bar);
-	if (!result || percentage != 25 || wob_color_to_argb(background) != 0xFF000000 || wob_color_to_argb(border) != 0xFF16a085 || wob_color_to_argb(bar) != 0xFFFF0000) {
+	if (!result || percentage != 25 || background.argb != 0xFF000000 || border.argb != 0xFF16a085 || bar.argb != 0xFFFF0000) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 6\n");
+	input = "25 #000000FG #FFFFFFFF #FFFFFFFF\n";
+	result = wob_parse_input(input, &percentage, &background, &border, &bar);
+	if (result) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 7\n");
+	input = "25 #0000\n";
+	result = wob_parse_input(input, &percentage, &background, &border, &bar);
+	if (result) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 8\n");
+	input = "99999999999999999999999\n";
+	result = wob_parse_input(input, &percentage, &background, &border, &bar);
+	if (result) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 9\n");
+	input = "25 #FFFFFF80 #16a08580 #FF000000\n";
+	result = wob_parse_input(input, &percentage, &background, &border, &bar);
+	if (!result || background.argb != 0x80808080 || border.argb != 0x800B5043 || bar.argb != 0x00000000) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 10\n");
+	input = "+5\n";
+	result = wob_parse_command(input, &command, &percentage, &background, &border, &bar);
+	if (!result || command != WOB_COMMAND_INCREASE || percentage != 5) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 11\n");
+	input = "-10 #000000FF #FFFFFFFF #FFFFFFFF\n";
+	result = wob_parse_command(input, &command, &percentage, &background, &border, &bar);
+	if (!result || command != WOB_COMMAND_DECREASE || percentage != 10 || background.argb != 0xFF000000) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 12\n");
+	input = "refresh-timeout\n";
+	percentage = 42;
+	result = wob_parse_command(input, &command, &percentage, &background, &border, &bar);
+	if (!result || command != WOB_COMMAND_REFRESH_TIMEOUT || percentage != 0) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 13\n");
+	input = "42\n";
+	result = wob_parse_command(input, &command, &percentage, &background, &border, &bar);
+	if (!result || command != WOB_COMMAND_SET || percentage != 42) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 14\n");
+	input = "showing\n";
+	result = wob_parse_command(input, &command, &percentage, &background, &border, &bar);
+	if (result) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 15\n");
+	input = "+-5\n";
+	result = wob_parse_command(input, &command, &percentage, &background, &border, &bar);
+	if (result) {
 		return EXIT_FAILURE;
 	}
 
@@ -0,0 +1,44 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "parse.h"
+
+#define ITERATIONS 2000000
+
+int
+main(int argc, char **argv)
+{
+	const char *inputs[] = {
+		"25\n",
+		"100\n",
+		"25 #000000FF #FFFFFFFF #FFFFFFFF\n",
+		"75 #000000ff #16a085FF #ff0000FF\n",
+	};
+
+	unsigned long percentage;
+	struct wob_color background = {0};
+	struct wob_color border = {0};
+	struct wob_color bar = {0};
+	unsigned long checksum = 0;
+
+	struct timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	for (size_t i = 0; i < ITERATIONS; ++i) {
+		const char *input = inputs[i % (sizeof(inputs) / sizeof(inputs[0]))];
+		if (!wob_parse_input(input, &percentage, &background, &border, &bar)) {
+			return EXIT_FAILURE;
+		}
+		checksum += percentage;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+	printf("parsed %d lines in %.3f s, %.1f ns/line, %.2f M lines/s (checksum %lu)\n", ITERATIONS, seconds, seconds * 1e9 / ITERATIONS, ITERATIONS / seconds / 1e6, checksum);
+
+	return EXIT_SUCCESS;
+}
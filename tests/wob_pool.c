@@ -0,0 +1,67 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "pool.h"
+
+#define WOB_TEST_JOBS 64
+
+void
+square(void *data, size_t index)
+{
+	unsigned long *results = data;
+	results[index] = index * index;
+}
+
+bool
+check(const unsigned long *results)
+{
+	for (size_t i = 0; i < WOB_TEST_JOBS; ++i) {
+		if (results[i] != i * i) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+int
+main(int argc, char **argv)
+{
+	struct wob_pool pool;
+	unsigned long results[WOB_TEST_JOBS];
+
+	printf("running 1\n");
+	if (!wob_pool_init(&pool, 0)) {
+		return EXIT_FAILURE;
+	}
+	wob_pool_run(&pool, square, results, WOB_TEST_JOBS);
+	if (!check(results) || pool.worker_count != 0) {
+		return EXIT_FAILURE;
+	}
+	wob_pool_finish(&pool);
+
+	printf("running 2\n");
+	if (!wob_pool_init(&pool, WOB_POOL_MAX_WORKERS)) {
+		return EXIT_FAILURE;
+	}
+	wob_pool_run(&pool, square, results, 1);
+	if (pool.worker_count != 0) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 3\n");
+	for (int round = 0; round < 100; ++round) {
+		for (size_t i = 0; i < WOB_TEST_JOBS; ++i) {
+			results[i] = 0;
+		}
+		wob_pool_run(&pool, square, results, WOB_TEST_JOBS);
+		if (!check(results) || pool.worker_count != WOB_POOL_MAX_WORKERS) {
+			return EXIT_FAILURE;
+		}
+	}
+	wob_pool_finish(&pool);
+
+	return EXIT_SUCCESS;
+}
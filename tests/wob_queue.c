@@ -0,0 +1,92 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "queue.h"
+
+#define WOB_TEST_UPDATES 100000
+
+static struct wob_queue queue;
+
+void *
+produce(void *data)
+{
+	for (unsigned long i = 1; i <= WOB_TEST_UPDATES; ++i) {
+		struct wob_update update = {.percentage = i, .bar.argb = i};
+		while (!wob_queue_push(&queue, &update)) {
+			sched_yield();
+		}
+	}
+
+	return NULL;
+}
+
+int
+main(int argc, char **argv)
+{
+	struct wob_update update = {0};
+
+	printf("running 1\n");
+	wob_queue_init(&queue);
+	if (wob_queue_pop(&queue, &update)) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 2\n");
+	for (unsigned long i = 0; i < WOB_QUEUE_CAPACITY; ++i) {
+		update.percentage = i;
+		if (!wob_queue_push(&queue, &update)) {
+			return EXIT_FAILURE;
+		}
+	}
+	if (wob_queue_push(&queue, &update)) {
+		return EXIT_FAILURE;
+	}
+	for (unsigned long i = 0; i < WOB_QUEUE_CAPACITY; ++i) {
+		if (!wob_queue_pop(&queue, &update) || update.percentage != i) {
+			return EXIT_FAILURE;
+		}
+	}
+	if (wob_queue_pop(&queue, &update)) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 3\n");
+	// batch of the input thread, commands and their values come out in order
+	const struct wob_update batch[] = {
+		{.command = WOB_COMMAND_SET, .percentage = 50},
+		{.command = WOB_COMMAND_INCREASE, .percentage = 5},
+		{.command = WOB_COMMAND_SHOW, .percentage = 0},
+	};
+	for (size_t i = 0; i < sizeof(batch) / sizeof(batch[0]); ++i) {
+		if (!wob_queue_push(&queue, &batch[i])) {
+			return EXIT_FAILURE;
+		}
+	}
+	for (size_t i = 0; i < sizeof(batch) / sizeof(batch[0]); ++i) {
+		if (!wob_queue_pop(&queue, &update) || update.command != batch[i].command || update.percentage != batch[i].percentage) {
+			return EXIT_FAILURE;
+		}
+	}
+
+	printf("running 4\n");
+	pthread_t producer;
+	if (pthread_create(&producer, NULL, produce, NULL) != 0) {
+		return EXIT_FAILURE;
+	}
+	for (unsigned long expected = 1; expected <= WOB_TEST_UPDATES;) {
+		if (!wob_queue_pop(&queue, &update)) {
+			sched_yield();
+			continue;
+		}
+		if (update.percentage != expected || update.bar.argb != expected) {
+			return EXIT_FAILURE;
+		}
+		expected += 1;
+	}
+	pthread_join(producer, NULL);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,101 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "input.h"
+#include "server.h"
+
+int
+wob_connect(const char *path)
+{
+	struct sockaddr_un address = {.sun_family = AF_UNIX};
+	strcpy(address.sun_path, path);
+
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd == -1 || connect(fd, (struct sockaddr *) &address, sizeof(address)) != 0) {
+		return -1;
+	}
+
+	return fd;
+}
+
+int
+main(int argc, char **argv)
+{
+	struct wob_input input;
+	char *line;
+
+	char directory[] = "/tmp/wob-test-XXXXXX";
+	if (mkdtemp(directory) == NULL) {
+		return EXIT_FAILURE;
+	}
+	char path[sizeof(directory) + sizeof("/wob.sock")];
+	snprintf(path, sizeof(path), "%s/wob.sock", directory);
+
+	printf("running 1\n");
+	unsetenv("LISTEN_PID");
+	if (wob_server_listen_fds() != 0) {
+		return EXIT_FAILURE;
+	}
+	setenv("LISTEN_PID", "1", 1);
+	setenv("LISTEN_FDS", "1", 1);
+	if (wob_server_listen_fds() != 0) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 2\n");
+	int listen_fd = wob_server_listen(path);
+	if (listen_fd == -1 || wob_server_accept(listen_fd) != -1) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 3\n");
+	int first = wob_connect(path);
+	int second = wob_connect(path);
+	int first_accepted = wob_server_accept(listen_fd);
+	int second_accepted = wob_server_accept(listen_fd);
+	if (first == -1 || second == -1 || first_accepted == -1 || second_accepted == -1) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 4\n");
+	if (write(second, "20\n", 3) != 3 || !wob_input_init(&input, second_accepted) || wob_input_fill(&input) != WOB_INPUT_AGAIN) {
+		return EXIT_FAILURE;
+	}
+	line = wob_input_next_line(&input);
+	if (line == NULL || strcmp(line, "20\n") != 0) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 5\n");
+	close(first);
+	if (!wob_input_init(&input, first_accepted) || wob_input_fill(&input) != WOB_INPUT_EOF) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 6\n");
+	if (wob_server_listen(path) != -1) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 7\n");
+	close(listen_fd);
+	listen_fd = wob_server_listen(path);
+	if (listen_fd == -1) {
+		return EXIT_FAILURE;
+	}
+
+	close(listen_fd);
+	close(second);
+	close(first_accepted);
+	close(second_accepted);
+	unlink(path);
+	rmdir(directory);
+
+	return EXIT_SUCCESS;
+}
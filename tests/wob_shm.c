@@ -0,0 +1,97 @@
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "input.h"
+#include "server.h"
+#include "shm.h"
+
+int
+main(int argc, char **argv)
+{
+	struct wob_input input;
+	struct wob_shm_snapshot snapshot;
+	struct wob_shm *shm;
+	int event_fd;
+
+	char directory[] = "/tmp/wob-test-XXXXXX";
+	if (mkdtemp(directory) == NULL) {
+		return EXIT_FAILURE;
+	}
+	char path[sizeof(directory) + sizeof("/wob.sock")];
+	snprintf(path, sizeof(path), "%s/wob.sock", directory);
+
+	printf("running 1\n");
+	int listen_fd = wob_server_listen(path);
+	int fd = wob_shm_connect(path, "volume", &shm, &event_fd);
+	int accepted = wob_server_accept(listen_fd);
+	if (listen_fd == -1 || fd == -1 || accepted == -1 || !wob_input_init(&input, accepted)) {
+		return EXIT_FAILURE;
+	}
+	input.receive_fds = true;
+	if (wob_input_fill(&input) != WOB_INPUT_AGAIN || input.fd_count != 2) {
+		return EXIT_FAILURE;
+	}
+	char *line = wob_input_next_line(&input);
+	if (line == NULL || strcmp(line, "volume shm\n") != 0) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 2\n");
+	const struct wob_shm *mapped = wob_server_map_shm(input.fds[0]);
+	if (mapped == NULL || !wob_shm_read(mapped, &snapshot) || snapshot.sequence != 0) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 3\n");
+	uint64_t wakeups;
+	if (!wob_shm_send(shm, event_fd, 25, 0, 0, 0, 0) || !wob_shm_send(shm, event_fd, 30, WOB_SHM_FLAG_COLORS, 0xFF000000, 0xFFFFFFFF, 0xFF16a085)) {
+		return EXIT_FAILURE;
+	}
+	if (read(input.fds[1], &wakeups, sizeof(wakeups)) != sizeof(wakeups) || wakeups != 2) {
+		return EXIT_FAILURE;
+	}
+	if (!wob_shm_read(mapped, &snapshot) || snapshot.sequence != 4 || snapshot.value != 30 || snapshot.flags != WOB_SHM_FLAG_COLORS || snapshot.bar != 0xFF16a085) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 4\n");
+	struct wob_color background, border, bar;
+	if (!wob_shm_send(shm, event_fd, 35, WOB_SHM_FLAG_COLORS, 0x00FFFFFF, 0xFFFFFFFF, 0x80FFFFFF) || !wob_shm_read(mapped, &snapshot)) {
+		return EXIT_FAILURE;
+	}
+	wob_server_shm_colors(&snapshot, &background, &border, &bar);
+	if (background.argb != 0 || border.argb != 0xFFFFFFFF || bar.argb != 0x80808080) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 5\n");
+	shm->sequence += 1;
+	if (wob_shm_read(mapped, &snapshot)) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 6\n");
+	int unsealed = memfd_create("wob-test", MFD_CLOEXEC);
+	if (unsealed == -1 || ftruncate(unsealed, sizeof(struct wob_shm)) != 0 || wob_server_map_shm(unsealed) != NULL) {
+		return EXIT_FAILURE;
+	}
+
+	close(unsealed);
+	wob_server_unmap_shm(mapped);
+	munmap(shm, sizeof(struct wob_shm));
+	close(input.fds[0]);
+	close(input.fds[1]);
+	close(event_fd);
+	close(fd);
+	close(accepted);
+	close(listen_fd);
+	unlink(path);
+	rmdir(directory);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,57 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "source.h"
+
+int
+main(int argc, char **argv)
+{
+	long long result;
+
+	printf("running 1\n");
+	if (!wob_source_eval("value * 100 / max", 120, 480, &result) || result != 25) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 2\n");
+	if (!wob_source_eval("(max - value)*2 + -3 % 2", 10, 60, &result) || result != 99) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 3\n");
+	if (wob_source_eval("value / (max - 100)", 10, 100, &result) || wob_source_eval("value +", 10, 100, &result) || wob_source_eval("values", 10, 100, &result) ||
+		wob_source_eval("9223372036854775807 * 2", 0, 0, &result)) {
+		return EXIT_FAILURE;
+	}
+
+	char path[] = "/tmp/wob-test-XXXXXX";
+	int fd = mkstemp(path);
+	if (fd == -1) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 4\n");
+	if (write(fd, "937\n", 4) != 4 || !wob_source_read(fd, &result) || result != 937) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 5\n");
+	if (pwrite(fd, "12  \n", 5, 0) != 5 || !wob_source_read(fd, &result) || result != 12) {
+		return EXIT_FAILURE;
+	}
+
+	printf("running 6\n");
+	if (ftruncate(fd, 0) != 0 || pwrite(fd, "full\n", 5, 0) != 5 || wob_source_read(fd, &result)) {
+		return EXIT_FAILURE;
+	}
+
+	close(fd);
+	unlink(path);
+
+	return EXIT_SUCCESS;
+}